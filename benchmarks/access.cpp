@@ -0,0 +1,278 @@
+#include "benchmark.hpp"
+#include "libproperty/property.hpp"
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * Property access against the things it is supposed to cost the same as: a
+ * raw data member and a plain getter/setter pair.
+ *
+ * Every host stores a single `T`, so the "array of hosts" cases also show
+ * whether a property inflates its host.
+ */
+
+struct large {
+  std::array<double, 16> data;
+
+  friend bool operator==(large const& x, large const& y)
+  {
+    return x.data == y.data;
+  }
+};
+
+template <typename T>
+struct raw_host {
+  T value;
+};
+
+template <typename T>
+class method_host {
+  T value_;
+
+public:
+  T const& get_value() const
+  {
+    return value_;
+  }
+  T const& set_value(T const& x)
+  {
+    return value_ = x;
+  }
+};
+
+template <typename T>
+class rw_host {
+  using self = rw_host;
+
+  T const& get_value() const
+  {
+    return value.value;
+  }
+  T const& set_value(T const& x)
+  {
+    return value.value = x;
+  }
+
+public:
+  LIBPROPERTY_PROPERTY((T), value, get_value, set_value, self);
+};
+
+template <typename T>
+class wrapper_host {
+  struct plain {
+    T value;
+
+    template <typename Host>
+    T const& get(Host const&) const
+    {
+      return value;
+    }
+    template <typename Host>
+    T const& set(Host&, T const& x)
+    {
+      return value = x;
+    }
+  };
+
+public:
+  LIBPROPERTY_WRAP((plain), value, wrapper_host);
+};
+
+static_assert(sizeof(rw_host<int>) == sizeof(raw_host<int>));
+static_assert(sizeof(wrapper_host<int>) == sizeof(raw_host<int>));
+static_assert(sizeof(rw_host<large>) == sizeof(raw_host<large>));
+static_assert(sizeof(wrapper_host<large>) == sizeof(raw_host<large>));
+
+/* uniform access, so that every case runs exactly the same loop */
+template <typename T>
+T const& read(raw_host<T> const& h)
+{
+  return h.value;
+}
+template <typename T>
+void write(raw_host<T>& h, T const& x)
+{
+  h.value = x;
+}
+template <typename T>
+T const& read(method_host<T> const& h)
+{
+  return h.get_value();
+}
+template <typename T>
+void write(method_host<T>& h, T const& x)
+{
+  h.set_value(x);
+}
+template <typename T>
+T const& read(rw_host<T> const& h)
+{
+  return h.value;
+}
+template <typename T>
+void write(rw_host<T>& h, T const& x)
+{
+  h.value = x;
+}
+template <typename T>
+T const& read(wrapper_host<T> const& h)
+{
+  return h.value;
+}
+template <typename T>
+void write(wrapper_host<T>& h, T const& x)
+{
+  h.value = x;
+}
+
+/* two distinct values per type, so that writes can't be hoisted */
+template <typename T>
+struct values;
+
+template <>
+struct values<int> {
+  static constexpr char const* name = "int";
+  std::array<int, 2> v{ { 1, 2 } };
+};
+template <>
+struct values<std::string> {
+  static constexpr char const* name = "std::string";
+  std::array<std::string, 2> v{ { std::string(40, 'a'),
+      std::string(40, 'b') } };
+};
+template <>
+struct values<large> {
+  static constexpr char const* name = "large";
+  std::array<large, 2> v{ { large{ { { 1 } } }, large{ { { 2 } } } } };
+};
+
+constexpr std::size_t loop_iterations = 1 << 20;
+constexpr std::size_t hosts = 1 << 10;
+constexpr std::size_t array_iterations = loop_iterations / hosts;
+
+template <template <typename> class Host, typename T>
+void single_host(benchmark::runner& r, char const* name, values<T> const& vs)
+{
+  std::string const read_name = std::string{ "read/" } + name;
+  r.run(read_name.c_str(), loop_iterations, [&](std::size_t n) {
+    Host<T> h;
+    write(h, vs.v[0]);
+    for (std::size_t i = 0; i < n; ++i) {
+      benchmark::do_not_optimize(read(h));
+      benchmark::clobber_memory();
+    }
+  });
+  std::string const write_name = std::string{ "write/" } + name;
+  r.run(write_name.c_str(), loop_iterations, [&](std::size_t n) {
+    Host<T> h;
+    write(h, vs.v[0]);
+    for (std::size_t i = 0; i < n; ++i) {
+      write(h, vs.v[i & 1]);
+      benchmark::clobber_memory();
+    }
+    benchmark::do_not_optimize(h);
+  });
+}
+
+template <template <typename> class Host, typename T>
+void array_of_hosts(benchmark::runner& r, char const* name, values<T> const& vs)
+{
+  std::vector<Host<T>> hs(hosts);
+  std::string const write_name = std::string{ "array-write/" } + name;
+  r.run(write_name.c_str(), array_iterations * hosts, [&](std::size_t n) {
+    for (std::size_t i = 0; i < n / hosts; ++i) {
+      for (auto& h : hs) {
+        write(h, vs.v[i & 1]);
+      }
+      benchmark::clobber_memory();
+    }
+  });
+  std::string const read_name = std::string{ "array-read/" } + name;
+  r.run(read_name.c_str(), array_iterations * hosts, [&](std::size_t n) {
+    for (std::size_t i = 0; i < n / hosts; ++i) {
+      std::size_t equal = 0;
+      for (auto const& h : hs) {
+        equal += read(h) == vs.v[0];
+      }
+      benchmark::do_not_optimize(equal);
+      benchmark::clobber_memory();
+    }
+  });
+}
+
+template <typename T>
+void all_hosts(benchmark::runner& r)
+{
+  values<T> const vs;
+  std::string const group = std::string{ "access: " } + values<T>::name;
+  r.group(group.c_str());
+  single_host<raw_host>(r, "raw member", vs);
+  single_host<method_host>(r, "member function", vs);
+  single_host<rw_host>(r, "rw_property", vs);
+  single_host<wrapper_host>(r, "wrapper", vs);
+
+  std::string const array_group
+      = std::string{ "array of hosts: " } + values<T>::name;
+  r.group(array_group.c_str());
+  array_of_hosts<raw_host>(r, "raw member", vs);
+  array_of_hosts<method_host>(r, "member function", vs);
+  array_of_hosts<rw_host>(r, "rw_property", vs);
+  array_of_hosts<wrapper_host>(r, "wrapper", vs);
+}
+
+/* the free operators of `wrapper` (LIBPROPERTY__DECLARE_OPERATOR) against the
+ * same expressions on the raw member */
+void operators(benchmark::runner& r)
+{
+  r.group("operators: int");
+
+  std::vector<raw_host<int>> raw(hosts);
+  std::vector<wrapper_host<int>> wrapped(hosts);
+  for (std::size_t i = 0; i < hosts; ++i) {
+    write(raw[i], static_cast<int>(i));
+    write(wrapped[i], static_cast<int>(i));
+  }
+
+  auto const arithmetic = [](auto const& hs) {
+    return [&hs](std::size_t n) {
+      for (std::size_t i = 0; i < n / hosts; ++i) {
+        int sum = 0;
+        for (auto const& h : hs) {
+          sum += h.value * 3 + 1;
+        }
+        benchmark::do_not_optimize(sum);
+        benchmark::clobber_memory();
+      }
+    };
+  };
+  r.run("arithmetic/raw member", array_iterations * hosts, arithmetic(raw));
+  r.run("arithmetic/wrapper", array_iterations * hosts, arithmetic(wrapped));
+
+  auto const comparison = [](auto const& hs) {
+    return [&hs](std::size_t n) {
+      for (std::size_t i = 0; i < n / hosts; ++i) {
+        int less = 0;
+        for (auto const& h : hs) {
+          less += (h.value < 512) + (h.value == 7);
+        }
+        benchmark::do_not_optimize(less);
+        benchmark::clobber_memory();
+      }
+    };
+  };
+  r.run("comparison/raw member", array_iterations * hosts, comparison(raw));
+  r.run("comparison/wrapper", array_iterations * hosts, comparison(wrapped));
+}
+
+int main(int argc, char** argv)
+{
+  benchmark::runner r{ argc, argv };
+  all_hosts<int>(r);
+  all_hosts<std::string>(r);
+  all_hosts<large>(r);
+  operators(r);
+}
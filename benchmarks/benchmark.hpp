@@ -0,0 +1,134 @@
+#ifndef INCLUDED_LIBPROPERTY_BENCHMARKS_BENCHMARK_HPP
+#define INCLUDED_LIBPROPERTY_BENCHMARKS_BENCHMARK_HPP
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015, 2017 Gašper Ažman
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/*
+ * A deliberately tiny benchmark harness, so that the benchmarks build with
+ * nothing but the standard library.
+ *
+ * Every case is run `repetitions` times and the fastest run is reported, as
+ * nanoseconds per operation and as a ratio to the baseline of its operation,
+ * which is what regressions show up in. A case is named "operation/variant";
+ * the first case of each operation run after `group()` is its baseline, so
+ * that writes are compared to raw writes, not to raw reads.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifndef LIBPROPERTY_BENCHMARK_LEVEL
+#define LIBPROPERTY_BENCHMARK_LEVEL "?"
+#endif
+
+#ifdef LIBPROPERTY_FLATTEN
+#define LIBPROPERTY_BENCHMARK_CONFIG LIBPROPERTY_BENCHMARK_LEVEL ", flattened"
+#else
+#define LIBPROPERTY_BENCHMARK_CONFIG LIBPROPERTY_BENCHMARK_LEVEL
+#endif
+
+namespace benchmark {
+
+/// Make the optimizer believe `value` is read.
+template <typename T>
+inline void do_not_optimize(T const& value)
+{
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/// Make the optimizer believe all memory is read and written.
+inline void clobber_memory()
+{
+  asm volatile("" : : : "memory");
+}
+
+class runner {
+  std::size_t scale_ = 1;
+  int repetitions_ = 5;
+  // per operation of the current group
+  std::vector<std::pair<std::string, double>> baselines_;
+
+  /// The baseline of the operation `name` names, `ns` if it is the first.
+  double baseline(char const* name, double ns)
+  {
+    std::string operation{ name };
+    operation.erase(std::min(operation.find('/'), operation.size()));
+    for (auto const& [op, baseline] : baselines_) {
+      if (op == operation) {
+        return baseline;
+      }
+    }
+    baselines_.emplace_back(std::move(operation), ns);
+    return ns;
+  }
+
+public:
+  /// The first command-line argument, if any, scales all iteration counts.
+  runner(int argc, char** argv)
+  {
+    if (argc > 1) {
+      scale_ = std::max(1l, std::strtol(argv[1], nullptr, 10));
+    }
+  }
+
+  /// Start a new group of cases; the next case of each operation is its
+  /// baseline.
+  void group(char const* name)
+  {
+    baselines_.clear();
+    std::printf("\n[%s] %s\n", LIBPROPERTY_BENCHMARK_CONFIG, name);
+  }
+
+  /// Run `f(iterations)`, which must perform `iterations` operations.
+  template <typename F>
+  void run(char const* name, std::size_t iterations, F&& f)
+  {
+    using clock = std::chrono::steady_clock;
+
+    iterations *= scale_;
+    auto best = clock::duration::max();
+    for (int i = 0; i < repetitions_; ++i) {
+      auto const start = clock::now();
+      f(iterations);
+      clobber_memory();
+      best = std::min(best, clock::now() - start);
+    }
+
+    double const ns
+        = std::chrono::duration<double, std::nano>(best).count() / iterations;
+    std::printf(
+        "  %-40s %10.3f ns/op %8.2fx\n", name, ns, ns / baseline(name, ns));
+  }
+};
+
+} // benchmark
+
+#endif
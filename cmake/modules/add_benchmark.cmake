@@ -0,0 +1,64 @@
+# Copyright 2015, 2016, 2017 Gašper Ažman
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+include(CMakeParseArguments)
+
+# arguments:
+# NAME: base name of the benchmark; one executable per level is built, named
+#       ${NAME}-${LEVEL}
+# LEVELS: optimization levels (without the leading dash), default O0 Og O2
+# DEFINITIONS: extra compile definitions
+# SOURCES: the sources of the benchmark
+#
+# Every executable is also appended to the LIBPROPERTY_BENCHMARKS global
+# property, so that the `benchmarks` target can run them one after the other.
+function(add_benchmark)
+  set(one_value_args NAME)
+  set(multi_value_args LEVELS DEFINITIONS SOURCES)
+  cmake_parse_arguments(OPT "" "${one_value_args}" "${multi_value_args}"
+                        ${ARGN})
+  if (NOT DEFINED OPT_NAME)
+    message(FATAL_ERROR "You need to supply the NAME parameter.")
+  endif()
+  if (NOT DEFINED OPT_SOURCES)
+    message(FATAL_ERROR "You need to supply the SOURCES parameter.")
+  endif()
+  if (NOT DEFINED OPT_LEVELS)
+    set(OPT_LEVELS O0 Og O2)
+  endif()
+
+  foreach(level ${OPT_LEVELS})
+    set(target ${OPT_NAME}-${level})
+    add_executable(${target} ${OPT_SOURCES})
+    target_compile_options(${target} PRIVATE -${level})
+    target_compile_definitions(${target} PRIVATE
+                               LIBPROPERTY_BENCHMARK_LEVEL="${level}"
+                               ${OPT_DEFINITIONS})
+    set_property(GLOBAL APPEND PROPERTY LIBPROPERTY_BENCHMARKS ${target})
+  endforeach()
+endfunction(add_benchmark)
+
+# Creates the `benchmarks` target, which runs every benchmark registered with
+# add_benchmark sequentially (so they don't compete for the CPU).
+function(add_benchmarks_target)
+  get_property(benchmarks GLOBAL PROPERTY LIBPROPERTY_BENCHMARKS)
+  set(commands)
+  foreach(target ${benchmarks})
+    list(APPEND commands COMMAND $<TARGET_FILE:${target}>)
+  endforeach()
+  add_custom_target(benchmarks ${commands}
+                    DEPENDS ${benchmarks}
+                    USES_TERMINAL)
+endfunction(add_benchmarks_target)
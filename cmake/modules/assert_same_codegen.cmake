@@ -0,0 +1,68 @@
+# Copyright 2015, 2016, 2017 Gašper Ažman
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+include(CMakeParseArguments)
+
+set(LIBPROPERTY_COMPARE_CODEGEN_SCRIPT
+    ${CMAKE_CURRENT_LIST_DIR}/compare_codegen.cmake)
+
+# Compiles SOURCE to assembly and checks that every function named
+# `codegen_<variant>__<case>` compiles to the same instructions as
+# `codegen_raw__<case>`. Those functions should be `extern "C"`, so that their
+# names are the same for every compiler.
+#
+# arguments:
+# TEST_NAME: name of the test
+# SOURCE: the reference translation unit
+# OPTIONS: compiler options, default -O2
+function(assert_same_codegen)
+  set(one_value_args TEST_NAME SOURCE)
+  set(multi_value_args OPTIONS)
+  cmake_parse_arguments(OPT "" "${one_value_args}" "${multi_value_args}"
+                        ${ARGN})
+  if (NOT DEFINED OPT_TEST_NAME)
+    message(FATAL_ERROR "You need to supply the TEST_NAME parameter.")
+  endif()
+  if (NOT DEFINED OPT_SOURCE)
+    message(FATAL_ERROR "You need to supply the SOURCE parameter.")
+  endif()
+  if (NOT DEFINED OPT_OPTIONS)
+    set(OPT_OPTIONS -O2)
+  endif()
+
+  get_filename_component(source ${OPT_SOURCE} ABSOLUTE)
+  set(asm ${CMAKE_CURRENT_BINARY_DIR}/${OPT_TEST_NAME}.s)
+  separate_arguments(flags UNIX_COMMAND "${CMAKE_CXX_FLAGS}")
+  file(GLOB headers ${CMAKE_SOURCE_DIR}/libproperty/*.hpp)
+  if (CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+    list(APPEND flags -fno-ipa-icf)
+  endif()
+
+  # no debug info or unwind tables: only the instructions are compared, and
+  # no identical-code folding, which would turn one of each pair into a jump
+  # to the other.
+  add_custom_command(OUTPUT ${asm}
+                     COMMAND ${CMAKE_CXX_COMPILER} ${flags} ${OPT_OPTIONS}
+                             -g0 -fno-asynchronous-unwind-tables
+                             -fno-exceptions
+                             -I${CMAKE_SOURCE_DIR}
+                             -S ${source} -o ${asm}
+                     DEPENDS ${source} ${headers}
+                     VERBATIM)
+  add_custom_target(${OPT_TEST_NAME} ALL DEPENDS ${asm})
+  add_test(NAME ${OPT_TEST_NAME}
+           COMMAND ${CMAKE_COMMAND} -DASM=${asm}
+                                    -P ${LIBPROPERTY_COMPARE_CODEGEN_SCRIPT})
+endfunction(assert_same_codegen)
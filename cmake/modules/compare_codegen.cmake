@@ -0,0 +1,94 @@
+# Copyright 2015, 2016, 2017 Gašper Ažman
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+# Script mode: cmake -DASM=<file.s> -P compare_codegen.cmake
+#
+# Collects the instructions of every `codegen_<variant>__<case>` function in
+# ASM and fails unless each one is identical to `codegen_raw__<case>`.
+# Directives and comments are dropped, and local labels are renamed to `.L`, so
+# that only the instruction stream is compared.
+
+if (NOT DEFINED ASM)
+  message(FATAL_ERROR "You need to supply the ASM parameter.")
+endif()
+
+file(STRINGS ${ASM} lines)
+
+set(functions)
+set(current)
+foreach(line IN LISTS lines)
+  if (line MATCHES "^_?(codegen_[A-Za-z0-9_]+):")
+    set(current ${CMAKE_MATCH_1})
+    list(APPEND functions ${current})
+    set(body_${current})
+  elseif (line MATCHES "^[A-Za-z_$][^ \t]*:")
+    # some other function, or a `.cold` part split off by the compiler
+    set(current)
+  elseif (current)
+    string(REGEX REPLACE "[ \t]*[#@;].*$" "" line "${line}")
+    string(STRIP "${line}" line)
+    if (line MATCHES "^\\.size" OR line MATCHES "^\\.cfi_endproc")
+      set(current)
+    elseif (line STREQUAL "")
+    elseif (line MATCHES "^\\.L[A-Za-z0-9_]*:$")
+      list(APPEND body_${current} ".L:")
+    elseif (line MATCHES "^\\.")
+      # directive
+    else()
+      string(REGEX REPLACE "\\.L[A-Za-z0-9_]+" ".L" line "${line}")
+      string(REGEX REPLACE "[ \t]+" " " line "${line}")
+      list(APPEND body_${current} "${line}")
+    endif()
+  endif()
+endforeach()
+
+set(compared 0)
+set(failed 0)
+foreach(function IN LISTS functions)
+  if (NOT function MATCHES "^codegen_(.+)__(.+)$")
+    message(FATAL_ERROR "${function}: expected codegen_<variant>__<case>")
+  endif()
+  set(variant ${CMAKE_MATCH_1})
+  set(case ${CMAKE_MATCH_2})
+  if (variant STREQUAL "raw")
+    continue()
+  endif()
+
+  set(reference codegen_raw__${case})
+  if (NOT DEFINED body_${reference})
+    message(SEND_ERROR "${function}: there is no ${reference} to compare to")
+    math(EXPR failed "${failed} + 1")
+    continue()
+  endif()
+
+  math(EXPR compared "${compared} + 1")
+  if (NOT body_${function} STREQUAL body_${reference})
+    math(EXPR failed "${failed} + 1")
+    string(REPLACE ";" "\n    " expected "${body_${reference}}")
+    string(REPLACE ";" "\n    " actual "${body_${function}}")
+    message(SEND_ERROR "${function} differs from ${reference}\n"
+                       "  ${reference}:\n    ${expected}\n"
+                       "  ${function}:\n    ${actual}\n")
+  else()
+    message(STATUS "${function}: same as ${reference}")
+  endif()
+endforeach()
+
+if (compared EQUAL 0)
+  message(FATAL_ERROR "no codegen_<variant>__<case> functions in ${ASM}")
+endif()
+if (failed GREATER 0)
+  message(FATAL_ERROR "${failed} of ${compared} functions differ")
+endif()
@@ -0,0 +1,253 @@
+#ifndef INCLUDED_LIBPROPERTY_ATOMIC_HPP
+#define INCLUDED_LIBPROPERTY_ATOMIC_HPP
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015, 2017 Gašper Ažman
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "modify.hpp"
+#include "wrapper.hpp"
+
+#include <atomic>
+#include <type_traits>
+#include <utility>
+
+// A wrapped property whose storage is a std::atomic<T>, with sequentially
+// consistent operations. For other memory orders, wrap
+// `libproperty::atomic<T, order>` directly.
+#define LIBPROPERTY_ATOMIC(type, name, host)                                   \
+  LIBPROPERTY_WRAP(                                                            \
+      (::libproperty::atomic<LIBPROPERTY__PARENTHESIZED_TYPE type>), name, host)
+
+namespace libproperty {
+
+/**
+ * `wrapper` policy that stores a `std::atomic<T>`, so the host is exactly as
+ * large as the atomic.
+ *
+ * Reading the property loads, assigning stores, and the compound operators
+ * and increments use the atomic read-modify-write operations where
+ * `std::atomic<T>` has them (`fetch_add` and friends), and a
+ * compare-exchange loop otherwise. `modify(f)` is a compare-exchange loop too,
+ * so `f` may be called more than once.
+ *
+ * `Order` is the order of read-modify-write operations; loads and stores use
+ * the strongest order they allow that is no stronger than `Order`.
+ *
+ * The rest of the std::atomic interface is available through the free
+ * functions below, e.g. `libproperty::exchange(host.prop, x)`.
+ */
+template <typename T, std::memory_order Order = std::memory_order_seq_cst>
+class atomic {
+  std::atomic<T> value_;
+
+public:
+  using value_type = T;
+
+  static constexpr std::memory_order order = Order;
+  static constexpr std::memory_order load_order
+      = Order == std::memory_order_release
+      ? std::memory_order_relaxed
+      : Order == std::memory_order_acq_rel ? std::memory_order_acquire : Order;
+  static constexpr std::memory_order store_order
+      = Order == std::memory_order_acquire || Order == std::memory_order_consume
+      ? std::memory_order_relaxed
+      : Order == std::memory_order_acq_rel ? std::memory_order_release : Order;
+
+  atomic() noexcept = default;
+  constexpr atomic(T x) noexcept
+      : value_(x)
+  {
+  }
+
+  /* the std::atomic interface */
+  T load(std::memory_order o = load_order) const noexcept
+  {
+    return value_.load(o);
+  }
+  void store(T x, std::memory_order o = store_order) noexcept
+  {
+    value_.store(x, o);
+  }
+  T exchange(T x, std::memory_order o = Order) noexcept
+  {
+    return value_.exchange(x, o);
+  }
+  bool compare_exchange_weak(
+      T& expected, T desired, std::memory_order o = Order) noexcept
+  {
+    return value_.compare_exchange_weak(expected, desired, o, load_order);
+  }
+  bool compare_exchange_strong(
+      T& expected, T desired, std::memory_order o = Order) noexcept
+  {
+    return value_.compare_exchange_strong(expected, desired, o, load_order);
+  }
+#define LIBPROPERTY__DECLARE_FETCH_OP(fetch_op)                                \
+  template <typename U, typename A = std::atomic<T>>                           \
+  auto fetch_op(U x, std::memory_order o = Order) noexcept                     \
+      ->decltype(std::declval<A&>().fetch_op(x, o))                            \
+  {                                                                            \
+    return value_.fetch_op(x, o);                                              \
+  }                                                                            \
+  static_assert(true, "require semicolon")
+
+  LIBPROPERTY__DECLARE_FETCH_OP(fetch_add);
+  LIBPROPERTY__DECLARE_FETCH_OP(fetch_sub);
+  LIBPROPERTY__DECLARE_FETCH_OP(fetch_and);
+  LIBPROPERTY__DECLARE_FETCH_OP(fetch_or);
+  LIBPROPERTY__DECLARE_FETCH_OP(fetch_xor);
+#undef LIBPROPERTY__DECLARE_FETCH_OP
+
+  /* the wrapper protocol */
+  template <typename Host>
+  T get(Host const&) const noexcept
+  {
+    return load();
+  }
+  template <typename Host>
+  T set(Host const&, T x) noexcept
+  {
+    store(x);
+    return x;
+  }
+
+  /// compare-exchange loop; returns what `f` returns on the successful try
+  template <typename Host, typename F>
+  decltype(auto) modify(Host const&, F&& f)
+  {
+    T expected = load();
+    for (;;) {
+      T desired = expected;
+      if constexpr (std::is_void_v<std::invoke_result_t<F&, T&>>) {
+        f(desired);
+        if (compare_exchange_weak(expected, desired)) {
+          return;
+        }
+      } else {
+        auto result = f(desired);
+        if (compare_exchange_weak(expected, desired)) {
+          return result;
+        }
+      }
+    }
+  }
+
+#define LIBPROPERTY__DECLARE_FETCH_COMPOUND(operation, fetch_op)               \
+  template <typename Host, typename U, typename A = atomic>                    \
+  auto compound(Host const&, ops::operation, U&& x) noexcept                   \
+      ->decltype(std::declval<A&>().fetch_op(T(x)))                            \
+  {                                                                            \
+    return fetch_op(T(x));                                                     \
+  }                                                                            \
+  static_assert(true, "require semicolon")
+
+  LIBPROPERTY__DECLARE_FETCH_COMPOUND(plus_assign, fetch_add);
+  LIBPROPERTY__DECLARE_FETCH_COMPOUND(minus_assign, fetch_sub);
+  LIBPROPERTY__DECLARE_FETCH_COMPOUND(bit_and_assign, fetch_and);
+  LIBPROPERTY__DECLARE_FETCH_COMPOUND(bit_or_assign, fetch_or);
+  LIBPROPERTY__DECLARE_FETCH_COMPOUND(bit_xor_assign, fetch_xor);
+#undef LIBPROPERTY__DECLARE_FETCH_COMPOUND
+
+  // increments return the old value, which is what postfix ones need
+#define LIBPROPERTY__DECLARE_FETCH_INCREMENT(operation, fetch_op)              \
+  template <typename Host, typename A = atomic>                                \
+  auto compound(Host const&, ops::operation) noexcept                          \
+      ->decltype(std::declval<A&>().fetch_op(1))                               \
+  {                                                                            \
+    return fetch_op(1);                                                        \
+  }                                                                            \
+  static_assert(true, "require semicolon")
+
+  LIBPROPERTY__DECLARE_FETCH_INCREMENT(increment, fetch_add);
+  LIBPROPERTY__DECLARE_FETCH_INCREMENT(post_increment, fetch_add);
+  LIBPROPERTY__DECLARE_FETCH_INCREMENT(decrement, fetch_sub);
+  LIBPROPERTY__DECLARE_FETCH_INCREMENT(post_decrement, fetch_sub);
+#undef LIBPROPERTY__DECLARE_FETCH_INCREMENT
+};
+
+/* free functions for the rest of the std::atomic interface */
+template <typename T, std::memory_order Order, typename Tag>
+T load(wrapper<atomic<T, Order>, Tag> const& property,
+    std::memory_order o = atomic<T, Order>::load_order) noexcept
+{
+  return impl::access::value(property).load(o);
+}
+
+template <typename T, std::memory_order Order, typename Tag>
+void store(wrapper<atomic<T, Order>, Tag>& property,
+    std::common_type_t<T> x,
+    std::memory_order o = atomic<T, Order>::store_order) noexcept
+{
+  impl::access::value(property).store(x, o);
+}
+
+template <typename T, std::memory_order Order, typename Tag>
+T exchange(wrapper<atomic<T, Order>, Tag>& property,
+    std::common_type_t<T> x,
+    std::memory_order o = Order) noexcept
+{
+  return impl::access::value(property).exchange(x, o);
+}
+
+template <typename T, std::memory_order Order, typename Tag>
+bool compare_exchange_weak(wrapper<atomic<T, Order>, Tag>& property,
+    T& expected,
+    std::common_type_t<T> desired,
+    std::memory_order o = Order) noexcept
+{
+  return impl::access::value(property).compare_exchange_weak(
+      expected, desired, o);
+}
+
+template <typename T, std::memory_order Order, typename Tag>
+bool compare_exchange_strong(wrapper<atomic<T, Order>, Tag>& property,
+    T& expected,
+    std::common_type_t<T> desired,
+    std::memory_order o = Order) noexcept
+{
+  return impl::access::value(property).compare_exchange_strong(
+      expected, desired, o);
+}
+
+#define LIBPROPERTY__DECLARE_FETCH_OP(fetch_op)                                \
+  template <typename T, std::memory_order Order, typename Tag>                 \
+  auto fetch_op(wrapper<atomic<T, Order>, Tag>& property,                      \
+      std::common_type_t<T> x,                                                 \
+      std::memory_order o = Order) noexcept                                    \
+      ->decltype(impl::access::value(property).fetch_op(x, o))                 \
+  {                                                                            \
+    return impl::access::value(property).fetch_op(x, o);                       \
+  }                                                                            \
+  static_assert(true, "require semicolon")
+
+LIBPROPERTY__DECLARE_FETCH_OP(fetch_add);
+LIBPROPERTY__DECLARE_FETCH_OP(fetch_sub);
+LIBPROPERTY__DECLARE_FETCH_OP(fetch_and);
+LIBPROPERTY__DECLARE_FETCH_OP(fetch_or);
+LIBPROPERTY__DECLARE_FETCH_OP(fetch_xor);
+#undef LIBPROPERTY__DECLARE_FETCH_OP
+
+} // libproperty
+
+#endif
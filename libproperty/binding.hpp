@@ -0,0 +1,575 @@
+#ifndef INCLUDED_LIBPROPERTY_BINDING_HPP
+#define INCLUDED_LIBPROPERTY_BINDING_HPP
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015, 2017 Gašper Ažman
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/*
+ * Bindings: properties declared as functions of other properties, on the same
+ * host or on others, recomputed only when read after an input changed.
+ *
+ *   struct quote {
+ *     LIBPROPERTY_REACTIVE((double), price, quote);
+ *     LIBPROPERTY_REACTIVE((int), quantity, quote);
+ *     LIBPROPERTY_BOUND((double), total, quote);
+ *   };
+ *
+ *   libproperty::bind(q.total, std::multiplies<>{}, q.price, q.quantity);
+ *   q.price = 2; // marks q.total, and whatever is bound to it, stale
+ *   q.quantity = 3;
+ *   double t = q.total; // computes 2 * 3, once
+ *
+ * Reactive and bound properties are the nodes of a dependency graph, each
+ * with an intrusive list of the edges to the nodes bound to it. A write marks
+ * everything downstream stale, stopping at nodes that already are, so that a
+ * burst of writes costs one visit per node. A read of a stale node first
+ * reads its inputs, which recompute themselves if they are stale too, so each
+ * node is computed at most once per change, after all of its inputs: in
+ * topological order, and never from a mix of old and new values. All walks of
+ * the graph use worklists rather than recursion, so chains of any length fit
+ * in the stack.
+ *
+ * Not thread-safe: reading a bound property may recompute it.
+ */
+
+#include "config.hpp"
+#include "wrapper.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// A wrapped property that bound properties can depend on.
+#define LIBPROPERTY_REACTIVE(type, name, host)                                 \
+  LIBPROPERTY_WRAP(                                                            \
+      (::libproperty::reactive<LIBPROPERTY__PARENTHESIZED_TYPE type>),         \
+      name,                                                                    \
+      host)
+
+// A read-only wrapped property whose value libproperty::bind defines.
+#define LIBPROPERTY_BOUND(type, name, host)                                    \
+  LIBPROPERTY_WRAP(                                                            \
+      (::libproperty::bound<LIBPROPERTY__PARENTHESIZED_TYPE type>),            \
+      name,                                                                    \
+      host)
+
+namespace libproperty {
+
+namespace impl {
+  struct reactive_node;
+
+  /// An input of a bound property, in the input's list of dependents.
+  struct reactive_edge {
+    reactive_node* input = nullptr;
+    reactive_node* dependent = nullptr;
+    reactive_edge* prev = nullptr;
+    reactive_edge* next = nullptr;
+  };
+
+  /// The inputs of a bound property.
+  struct reactive_inputs {
+    std::unique_ptr<reactive_edge[]> inputs;
+    std::size_t count = 0;
+  };
+
+  /// What a bound property does for the graph; reactive ones have none.
+  struct reactive_operations {
+    /// Called on a dependent when one of its inputs is about to go away.
+    void (*release)(reactive_node&) noexcept;
+    /// Recomputes the value, once its inputs are up to date.
+    void (*refresh)(reactive_node&);
+    reactive_inputs const* (*inputs)(reactive_node const&) noexcept;
+  };
+
+  struct reactive_node {
+    reactive_operations const* ops;
+    reactive_edge* dependents = nullptr;
+    // the link of the worklist of whichever walk of the graph is running
+    reactive_node* next_work = nullptr;
+    // the walk that last visited the node
+    std::uint64_t visited = 0;
+    bool stale = false;
+
+    explicit reactive_node(reactive_operations const* o) noexcept
+        : ops(o)
+    {
+    }
+    reactive_node(reactive_node const&) = delete;
+    reactive_node& operator=(reactive_node const&) = delete;
+
+    /// A stamp no node has been visited with, by any thread.
+    static std::uint64_t next_walk() noexcept
+    {
+      static std::atomic<std::uint64_t> walks{ 0 };
+      return walks.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    void link(reactive_edge& e) noexcept
+    {
+      e.prev = nullptr;
+      e.next = dependents;
+      if (dependents != nullptr) {
+        dependents->prev = &e;
+      }
+      dependents = &e;
+    }
+    void unlink(reactive_edge& e) noexcept
+    {
+      (e.prev ? e.prev->next : dependents) = e.next;
+      if (e.next != nullptr) {
+        e.next->prev = e.prev;
+      }
+      e.prev = e.next = nullptr;
+    }
+
+    /// Marks everything downstream stale, without recursing.
+    void invalidate_dependents() noexcept
+    {
+      reactive_node* work = nullptr;
+      auto const push = [&work](reactive_node const& n) {
+        for (auto* e = n.dependents; e != nullptr; e = e->next) {
+          auto* const d = e->dependent;
+          if (!d->stale) {
+            d->stale = true;
+            d->next_work = work;
+            work = d;
+          }
+        }
+      };
+      push(*this);
+      while (work != nullptr) {
+        auto* const n = work;
+        work = n->next_work;
+        n->next_work = nullptr;
+        push(*n);
+      }
+    }
+
+    /**
+     * Whether `target` is downstream of this node. Visits each node at most
+     * once, without recursing.
+     */
+    bool reaches(reactive_node const* target) noexcept
+    {
+      auto const walk = next_walk();
+      reactive_node* work = nullptr;
+      bool found = false;
+      auto const push = [&](reactive_node const& n) {
+        for (auto* e = n.dependents; e != nullptr; e = e->next) {
+          auto* const d = e->dependent;
+          found = found || d == target;
+          if (d->visited != walk) {
+            d->visited = walk;
+            d->next_work = work;
+            work = d;
+          }
+        }
+      };
+      visited = walk;
+      push(*this);
+      while (work != nullptr) {
+        auto* const n = work;
+        work = n->next_work;
+        n->next_work = nullptr;
+        if (!found) {
+          push(*n);
+        }
+      }
+      return found;
+    }
+
+    /**
+     * Recomputes this stale node after the stale nodes upstream of it, each
+     * after its own inputs, without recursing: so reading the end of a long
+     * chain of bindings does not take stack in proportion to its length.
+     */
+    void refresh()
+    {
+      struct frame {
+        reactive_node* node;
+        std::size_t next_input;
+      };
+      auto const* const own = ops->inputs(*this);
+      auto const fresh = [own] {
+        for (std::size_t i = 0; i < own->count; ++i) {
+          if (own->inputs[i].input->stale) {
+            return false;
+          }
+        }
+        return true;
+      };
+      if (fresh()) {
+        ops->refresh(*this);
+        return;
+      }
+      auto const walk = next_walk();
+      std::vector<frame> path{ frame{ this, 0 } };
+      visited = walk;
+      while (!path.empty()) {
+        auto const [n, i] = path.back();
+        auto const* const in = n->ops->inputs(*n);
+        if (i < in->count) {
+          ++path.back().next_input;
+          auto* const input = in->inputs[i].input;
+          if (input->stale && input->visited != walk) {
+            input->visited = walk;
+            path.push_back(frame{ input, 0 });
+          }
+        } else {
+          path.pop_back();
+          n->ops->refresh(*n);
+        }
+      }
+    }
+
+    /// Lets the dependents keep their values and forget this input.
+    void release_dependents() noexcept
+    {
+      while (dependents != nullptr) {
+        auto* const d = dependents->dependent;
+        d->ops->release(*d);
+      }
+    }
+  };
+
+  template <typename T>
+  struct binding : reactive_inputs {
+    std::function<T()> compute;
+  };
+
+  template <typename Policy>
+  struct reactive_policy;
+} // impl
+
+/**
+ * `wrapper` policy for a value that bound properties can depend on: writes
+ * mark everything bound to it, directly or not, stale.
+ *
+ * Copies of the policy (and so of the host) copy the value, not what is
+ * bound to it. Destroying it leaves what was bound to it with the values it
+ * last computed, and no longer bound.
+ */
+template <typename T>
+class reactive : private impl::reactive_node {
+  template <typename Policy>
+  friend struct impl::reactive_policy;
+
+  T value_;
+
+  impl::reactive_node& node() noexcept
+  {
+    return *this;
+  }
+
+public:
+  using value_type = T;
+
+  template <typename... Args,
+      typename = std::enable_if_t<std::is_constructible_v<T, Args&&...>>>
+  reactive(Args&&... args)
+      : impl::reactive_node(nullptr)
+      , value_(LIBPROPERTY__FORWARD(args)...)
+  {
+  }
+  reactive(reactive const& other)
+      : impl::reactive_node(nullptr)
+      , value_(other.value_)
+  {
+  }
+  reactive& operator=(reactive const& other)
+  {
+    value_ = other.value_;
+    node().invalidate_dependents();
+    return *this;
+  }
+  ~reactive()
+  {
+    node().release_dependents();
+  }
+
+  T const& current() const noexcept
+  {
+    return value_;
+  }
+
+  /* the wrapper protocol */
+  template <typename Host>
+  T const& get(Host const&) const noexcept
+  {
+    return value_;
+  }
+  template <typename Host,
+      typename X,
+      typename = std::enable_if_t<std::is_assignable_v<T&, X&&>>>
+  void set(Host const&, X&& x)
+  {
+    value_ = LIBPROPERTY__FORWARD(x);
+    node().invalidate_dependents();
+  }
+  template <typename Host, typename F>
+  decltype(auto) modify(Host const&, F&& f)
+  {
+    if constexpr (std::is_void_v<std::invoke_result_t<F&&, T&>>) {
+      LIBPROPERTY__FORWARD(f)(value_);
+      node().invalidate_dependents();
+    } else {
+      auto result = LIBPROPERTY__FORWARD(f)(value_);
+      node().invalidate_dependents();
+      return result;
+    }
+  }
+};
+
+/**
+ * `wrapper` policy for a read-only value computed from reactive or bound
+ * properties by libproperty::bind, when it is read after one of them changed.
+ * Until it is bound, or after it is unbound, it keeps the value it has.
+ *
+ * Copies of the policy (and so of the host) copy the value, not the binding:
+ * hosts that bind their own properties must bind them again in their copy
+ * constructors.
+ */
+template <typename T>
+class bound : private impl::reactive_node {
+  template <typename Policy>
+  friend struct impl::reactive_policy;
+
+  mutable T value_;
+  std::unique_ptr<impl::binding<T>> binding_;
+
+  // reading recomputes, so the node changes under const access
+  impl::reactive_node& node() const noexcept
+  {
+    return const_cast<bound&>(*this);
+  }
+
+  static void release(impl::reactive_node& node) noexcept
+  {
+    static_cast<bound&>(node).unbind();
+  }
+  static void refresh(impl::reactive_node& node)
+  {
+    auto const& self = static_cast<bound const&>(node);
+    self.value_ = self.binding_->compute();
+    node.stale = false;
+  }
+  static impl::reactive_inputs const* inputs(
+      impl::reactive_node const& node) noexcept
+  {
+    return static_cast<bound const&>(node).binding_.get();
+  }
+  static constexpr impl::reactive_operations operations{
+    &release, &refresh, &inputs
+  };
+
+  /// Stops depending on anything, keeping the value as it is.
+  void detach() noexcept
+  {
+    if (binding_ != nullptr) {
+      for (std::size_t i = 0; i < binding_->count; ++i) {
+        auto& e = binding_->inputs[i];
+        e.input->unlink(e);
+      }
+      binding_.reset();
+    }
+    node().stale = false;
+  }
+
+public:
+  using value_type = T;
+
+  template <typename... Args,
+      typename = std::enable_if_t<std::is_constructible_v<T, Args&&...>>>
+  bound(Args&&... args)
+      : impl::reactive_node(&operations)
+      , value_(LIBPROPERTY__FORWARD(args)...)
+  {
+  }
+  bound(bound const& other)
+      : impl::reactive_node(&operations)
+      , value_(other.current())
+  {
+  }
+  bound& operator=(bound const& other)
+  {
+    if (this != &other) {
+      value_ = other.current();
+      detach();
+      node().invalidate_dependents();
+    }
+    return *this;
+  }
+  ~bound()
+  {
+    node().release_dependents();
+    detach();
+  }
+
+  /// The value, recomputed first if an input changed since it was computed.
+  T const& current() const
+  {
+    if (node().stale) {
+      node().refresh();
+    }
+    return value_;
+  }
+
+  bool is_bound() const noexcept
+  {
+    return binding_ != nullptr;
+  }
+  bool is_stale() const noexcept
+  {
+    return node().stale;
+  }
+
+  /// Computes the value with `compute` from now on, depending on `inputs`.
+  void bind(std::unique_ptr<impl::binding<T>> b)
+  {
+    for (std::size_t i = 0; i < b->count; ++i) {
+      auto* const input = b->inputs[i].input;
+      if (input == &node() || node().reaches(input)) {
+        throw std::logic_error("libproperty bind: cyclic binding");
+      }
+    }
+    detach();
+    binding_ = std::move(b);
+    for (std::size_t i = 0; i < binding_->count; ++i) {
+      auto& e = binding_->inputs[i];
+      e.dependent = &node();
+      e.input->link(e);
+    }
+    node().stale = true;
+    node().invalidate_dependents();
+  }
+
+  /**
+   * Keeps the current value from now on. If it is stale, recomputes it first,
+   * while the inputs are still there; if that throws, keeps the stale one.
+   */
+  void unbind() noexcept
+  {
+    if (node().stale) {
+      try {
+        node().refresh();
+      } catch (...) {
+      }
+    }
+    detach();
+  }
+
+  /* the wrapper protocol */
+  template <typename Host>
+  T const& get(Host const&) const
+  {
+    return current();
+  }
+};
+
+namespace impl {
+  template <typename Policy>
+  struct reactive_policy : std::false_type {
+  };
+  template <typename T>
+  struct reactive_policy<reactive<T>> : std::true_type {
+    static reactive_node& node(reactive<T> const& p) noexcept
+    {
+      return const_cast<reactive<T>&>(p).node();
+    }
+  };
+  template <typename T>
+  struct reactive_policy<bound<T>> : std::true_type {
+    static reactive_node& node(bound<T> const& p) noexcept
+    {
+      return p.node();
+    }
+  };
+} // impl
+
+/**
+ * Binds `target` to `f(inputs...)`, where each input is a reactive or bound
+ * property, on any host, read as its value. `target` becomes stale at once,
+ * and again whenever an input, or anything an input depends on, is written.
+ * Replaces what `target` was bound to before.
+ *
+ * Destroying an input unbinds `target`, which keeps its last value. Throws
+ * std::logic_error if `target` is among what the inputs depend on.
+ */
+template <typename T, typename Tag, typename F, typename... Policies,
+    typename... Tags>
+void bind(wrapper<bound<T>, Tag>& target,
+    F&& f,
+    wrapper<Policies, Tags> const&... inputs)
+{
+  static_assert((impl::reactive_policy<Policies>::value && ...),
+      "inputs must be reactive or bound properties");
+  static_assert(sizeof...(inputs) > 0, "bind to a constant with assignment");
+
+  auto b = std::make_unique<impl::binding<T>>();
+  b->count = sizeof...(inputs);
+  b->inputs = std::make_unique<impl::reactive_edge[]>(sizeof...(inputs));
+  std::size_t i = 0;
+  ((b->inputs[i++].input
+       = &impl::reactive_policy<Policies>::node(impl::access::value(inputs))),
+      ...);
+  b->compute = [f = std::decay_t<F>(LIBPROPERTY__FORWARD(f)),
+                   policies = std::make_tuple(
+                       &impl::access::value(inputs)...)]() -> T {
+    return std::apply(
+        [&](auto const*... p) { return std::invoke(f, p->current()...); },
+        policies);
+  };
+  impl::access::value(target).bind(std::move(b));
+}
+
+/// Keeps the current value of `target` from now on.
+template <typename T, typename Tag>
+void unbind(wrapper<bound<T>, Tag>& target) noexcept
+{
+  impl::access::value(target).unbind();
+}
+
+template <typename T, typename Tag>
+bool is_bound(wrapper<bound<T>, Tag> const& target) noexcept
+{
+  return impl::access::value(target).is_bound();
+}
+
+/// Whether reading `target` would recompute it.
+template <typename T, typename Tag>
+bool is_stale(wrapper<bound<T>, Tag> const& target) noexcept
+{
+  return impl::access::value(target).is_stale();
+}
+
+} // libproperty
+
+#endif
@@ -0,0 +1,237 @@
+#ifndef INCLUDED_LIBPROPERTY_BITFIELD_HPP
+#define INCLUDED_LIBPROPERTY_BITFIELD_HPP
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015, 2017 Gašper Ažman
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "instrument.hpp"
+#include "modify.hpp"
+#include "property_impl.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#define LIBPROPERTY__BITFIELD_TYPE(name) _libproperty__##name##_bitfield
+#define LIBPROPERTY__BITFIELD_WORD(name) _libproperty__##name##_bitfield_word
+
+// A property stored in bits [offset, offset + width) of the unsigned integer
+// data member `word` of `host`. Only call in class scope, before the anonymous
+// union that holds `word` and, through LIBPROPERTY_BITS, the property:
+//
+//   LIBPROPERTY_BITFIELD((bool), visible, state, 0, 1, host);
+//   union {
+//     std::uint32_t state = 0;
+//     LIBPROPERTY_BITS(visible);
+//   };
+#define LIBPROPERTY_BITFIELD(type, name, word, offset, width, host)            \
+  LIBPROPERTY__DECLARE_TAG(name, host);                                        \
+  struct LIBPROPERTY__BITFIELD_WORD(name) {                                    \
+    auto static constexpr member()                                             \
+    {                                                                          \
+      return &host::word;                                                      \
+    }                                                                          \
+  };                                                                           \
+  using LIBPROPERTY__BITFIELD_TYPE(name)                                       \
+      = ::libproperty::bitfield<LIBPROPERTY__PARENTHESIZED_TYPE type,          \
+          LIBPROPERTY__BITFIELD_WORD(name),                                    \
+          offset,                                                              \
+          width,                                                               \
+          host::LIBPROPERTY__TAG_NAME(name)>;                                  \
+  static_assert(true, "require semicolon")
+
+// The member of the anonymous union that a LIBPROPERTY_BITFIELD declared.
+#define LIBPROPERTY_BITS(name) LIBPROPERTY__BITFIELD_TYPE(name) name
+
+namespace libproperty {
+
+namespace impl {
+  template <typename T, bool = std::is_enum_v<T>>
+  struct bits_type {
+    using type = T;
+  };
+  template <typename T>
+  struct bits_type<T, true> {
+    using type = std::underlying_type_t<T>;
+  };
+} // impl
+
+/**
+ * A property of type `T` (an integer, `bool` or an enumeration) that lives in
+ * `Width` bits of an unsigned data member of its host, starting `Offset` bits
+ * from the bottom. `WordOf::member()` points to that member.
+ *
+ * The property has no storage of its own. It shares an anonymous union with the
+ * word, so several of them packed into one word cost no more than the word
+ * does; its own bytes are never read or written. Like any other property, it
+ * finds its host from its address, and reads and writes the word through the
+ * host. Reading is a shift and a mask, and signed values are sign-extended.
+ * Assigning masks off the bits that do not fit, like assigning to a bit-field
+ * does.
+ *
+ * Bitfields are registered like the other properties, so they take part in
+ * reflection, dirty tracking and instrumentation.
+ *
+ * Like the other properties, it can only be copied by its host.
+ */
+template <typename T,
+    typename WordOf,
+    unsigned Offset,
+    unsigned Width,
+    typename Tag>
+class bitfield {
+  static_assert(std::is_integral_v<T> || std::is_enum_v<T>,
+      "a bitfield holds an integer, a bool or an enumeration");
+  static_assert(
+      Width > 0 && Width <= std::numeric_limits<std::uintmax_t>::digits,
+      "the bitfield does not fit in any word");
+
+  using host = typename Tag::host_type;
+  using self = bitfield;
+  using bits = typename impl::bits_type<T>::type;
+  static constexpr std::uintmax_t mask = std::uintmax_t(-1)
+      >> (std::numeric_limits<std::uintmax_t>::digits - Width);
+
+  // allow the host, and so the anonymous union, to construct and copy it
+  friend host;
+  friend struct ::libproperty::impl::access;
+
+  constexpr bitfield() = default;
+  constexpr bitfield(bitfield const&) = default;
+  constexpr bitfield(bitfield&&) = default;
+  ~bitfield() = default;
+  constexpr bitfield& operator=(bitfield const&) = default;
+  constexpr bitfield& operator=(bitfield&&) = default;
+
+  /// The word, as const as `h`.
+  template <typename H>
+  LIBPROPERTY__ACCESSOR static constexpr auto& word(H& h) noexcept
+  {
+    using word_t = std::remove_cv_t<
+        std::remove_reference_t<decltype(h.*WordOf::member())>>;
+    static_assert(std::is_integral_v<word_t> && std::is_unsigned_v<word_t>,
+        "the word must be an unsigned integer");
+    static_assert(Offset + Width <= std::numeric_limits<word_t>::digits,
+        "the bitfield does not fit in the word");
+    return h.*WordOf::member();
+  }
+
+  /// The value in the word of `h`.
+  LIBPROPERTY__ACCESSOR static constexpr T load(host const& h) noexcept
+  {
+    auto const raw = (std::uintmax_t{ word(h) } >> Offset) & mask;
+    if constexpr (std::is_same_v<bits, bool>) {
+      return static_cast<T>(raw != 0);
+    } else if constexpr (std::is_signed_v<bits>) {
+      constexpr auto sign = std::uintmax_t{ 1 } << (Width - 1);
+      return static_cast<T>(static_cast<bits>(
+          static_cast<std::intmax_t>(raw ^ sign)
+          - static_cast<std::intmax_t>(sign)));
+    } else {
+      return static_cast<T>(static_cast<bits>(raw));
+    }
+  }
+
+  /// Puts `x` in the word of `h`, and nothing else.
+  LIBPROPERTY__ACCESSOR static constexpr void store(host& h, T x) noexcept
+  {
+    auto& w = word(h);
+    using word_t = std::remove_reference_t<decltype(w)>;
+    auto const raw = static_cast<std::uintmax_t>(static_cast<bits>(x)) & mask;
+    w = static_cast<word_t>(
+        (w & ~static_cast<word_t>(mask << Offset)) | (raw << Offset));
+  }
+
+public:
+  using value_type = T;
+  static constexpr unsigned offset = Offset;
+  static constexpr unsigned width = Width;
+
+  LIBPROPERTY__ACCESSOR T get() const noexcept
+  {
+    namespace pi = ::libproperty::impl;
+    [[maybe_unused]] pi::probe<Tag, pi::access_kind::read> const probe{};
+    return load(pi::get_host(*this));
+  }
+
+  LIBPROPERTY__ACCESSOR void set(T x) noexcept
+  {
+    namespace pi = ::libproperty::impl;
+    [[maybe_unused]] pi::probe<Tag, pi::access_kind::write> const probe{};
+    auto& h = pi::get_host(*this);
+    [[maybe_unused]] auto const written = pi::invalidate_after_write<self>(h);
+    store(h, x);
+  }
+
+  LIBPROPERTY__ACCESSOR operator T() const noexcept
+  {
+    return get();
+  }
+
+  LIBPROPERTY__ACCESSOR bitfield& operator=(T x) noexcept
+  {
+    set(x);
+    return *this;
+  }
+
+  /// Apply `f` to a copy of the value and store it back; see rw_property.
+  template <typename F>
+  LIBPROPERTY__ACCESSOR decltype(auto) modify(F&& f)
+  {
+    return ::libproperty::impl::modify_copy(
+        get(), LIBPROPERTY__FORWARD(f), [this](T x) { set(x); });
+  }
+
+  /// Apply `op(value, args...)`; see `modify`.
+  template <typename Op, typename... Args>
+  LIBPROPERTY__ACCESSOR decltype(auto) compound(Op op, Args&&... args)
+  {
+    return modify([&](auto& v) -> decltype(auto) {
+      return op(v, LIBPROPERTY__FORWARD(args)...);
+    });
+  }
+
+  template <typename Op, typename... Args>
+  static constexpr bool compound_applies = std::is_invocable_v<Op, T&, Args...>;
+
+  LIBPROPERTY__DECLARE_COMPOUND_OPERATORS();
+};
+
+template <typename T,
+    typename WordOf,
+    unsigned Offset,
+    unsigned Width,
+    typename Tag>
+struct property_traits<bitfield<T, WordOf, Offset, Width, Tag>>
+    : std::true_type {
+  static constexpr std::true_type is_property = {};
+  static constexpr property_kind kind = property_kind::bitfield;
+  using tag = Tag;
+  using value_type = T;
+  using meta = void;
+};
+
+} // libproperty
+
+#endif
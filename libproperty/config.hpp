@@ -0,0 +1,130 @@
+#ifndef INCLUDED_LIBPROPERTY_CONFIG_HPP
+#define INCLUDED_LIBPROPERTY_CONFIG_HPP
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015, 2017 Gašper Ažman
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/*
+ * Configuration macros. Define them before including any libproperty header.
+ *
+ * LIBPROPERTY_FLATTEN
+ *   Force-inline the library's own part of every property access (the
+ *   accessors, get_host, forward_like, ...) and mark it artificial, so that
+ *   unoptimized builds only pay for the host's getter and setter, and
+ *   debuggers step straight into them. Only has an effect with GCC and Clang.
+ *
+ * LIBPROPERTY_MAX_PROPERTIES
+ *   The largest number of properties a single host can declare. Defaults to
+ *   64. A host that declares more fails to compile, with a static_assert
+ *   naming this macro.
+ *
+ * LIBPROPERTY_STRIPES
+ *   The default number of locks in the stripe table of `striped` properties,
+ *   a power of two. Defaults to 64.
+ *
+ * LIBPROPERTY_INSTRUMENT
+ *   Count the reads and writes of every property; see instrument.hpp. Must be
+ *   defined the same way in every translation unit of a program.
+ *
+ * LIBPROPERTY_INSTRUMENT_LATENCY
+ *   Implies LIBPROPERTY_INSTRUMENT, and also records how long each access
+ *   takes.
+ */
+
+#include <memory>
+#include <new>
+
+#if defined(LIBPROPERTY_FLATTEN) && (defined(__GNUC__) || defined(__clang__))
+#define LIBPROPERTY__ACCESSOR [[gnu::always_inline, gnu::artificial]] inline
+#else
+#define LIBPROPERTY__ACCESSOR inline
+#endif
+
+#ifndef LIBPROPERTY_MAX_PROPERTIES
+#define LIBPROPERTY_MAX_PROPERTIES 64
+#endif
+
+#ifndef LIBPROPERTY_STRIPES
+#define LIBPROPERTY_STRIPES 64
+#endif
+
+#if defined(LIBPROPERTY_INSTRUMENT_LATENCY) && !defined(LIBPROPERTY_INSTRUMENT)
+#define LIBPROPERTY_INSTRUMENT
+#endif
+
+// Properties without a value of their own (LIBPROPERTY_EMPTY_PROPERTY) take no
+// room in their host where [[no_unique_address]] is available, from C++20 on.
+#if defined(_MSC_VER) && !defined(__clang__) && _MSVC_LANG >= 202002L
+#define LIBPROPERTY__NO_UNIQUE_ADDRESS [[msvc::no_unique_address]]
+#elif defined(__has_cpp_attribute) && __cplusplus >= 202002L
+#if __has_cpp_attribute(no_unique_address)
+#define LIBPROPERTY__NO_UNIQUE_ADDRESS [[no_unique_address]]
+#endif
+#endif
+#ifdef LIBPROPERTY__NO_UNIQUE_ADDRESS
+#define LIBPROPERTY__EMPTY_TAKES_NO_SPACE 1
+#else
+#define LIBPROPERTY__NO_UNIQUE_ADDRESS
+#define LIBPROPERTY__EMPTY_TAKES_NO_SPACE 0
+#endif
+
+// std::forward, std::addressof and std::launder are function calls at -O0.
+#define LIBPROPERTY__FORWARD(...)                                              \
+  static_cast<decltype(__VA_ARGS__)&&>(__VA_ARGS__)
+
+#if defined(__GNUC__) || defined(__clang__)
+#define LIBPROPERTY__ADDRESSOF(...) __builtin_addressof(__VA_ARGS__)
+#define LIBPROPERTY__LAUNDER(...) __builtin_launder(__VA_ARGS__)
+#else
+#define LIBPROPERTY__ADDRESSOF(...) ::std::addressof(__VA_ARGS__)
+#define LIBPROPERTY__LAUNDER(...) ::std::launder(__VA_ARGS__)
+#endif
+
+// Hosts stop being standard-layout as soon as a property's policy has a base
+// class, and offsetof on them is only conditionally-supported. GCC and Clang
+// support it for classes without virtual bases, which hosts must not have
+// anyway, since the offset of a property would not be constant.
+#if defined(__GNUC__) || defined(__clang__)
+#define LIBPROPERTY__ALLOW_OFFSETOF_BEGIN                                      \
+  _Pragma("GCC diagnostic push")                                               \
+      _Pragma("GCC diagnostic ignored \"-Winvalid-offsetof\"")
+#define LIBPROPERTY__ALLOW_OFFSETOF_END _Pragma("GCC diagnostic pop")
+#else
+#define LIBPROPERTY__ALLOW_OFFSETOF_BEGIN
+#define LIBPROPERTY__ALLOW_OFFSETOF_END
+#endif
+
+// std::hardware_destructive_interference_size is not reliably available.
+#define LIBPROPERTY__CACHE_LINE 64
+
+// Busy-wait hint for spin loops.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LIBPROPERTY__CPU_RELAX() __builtin_ia32_pause()
+#elif defined(__GNUC__) && defined(__aarch64__)
+#define LIBPROPERTY__CPU_RELAX() asm volatile("yield" ::: "memory")
+#else
+#define LIBPROPERTY__CPU_RELAX() static_cast<void>(0)
+#endif
+
+#endif
@@ -0,0 +1,181 @@
+#ifndef INCLUDED_LIBPROPERTY_DIRTY_HPP
+#define INCLUDED_LIBPROPERTY_DIRTY_HPP
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015, 2017 Gašper Ažman
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/*
+ * Dirty tracking: a host that declares LIBPROPERTY_DIRTY_TRACKING after its
+ * properties gets a bit per property, set by every write to it (assignment,
+ * `modify` and the compound operators) until cleared. For sending only what
+ * changed.
+ *
+ * A write marks its property before the setter runs, so a setter that throws,
+ * or that rejects the value, still leaves the bit set: dirty means written
+ * to, not changed. Bit-field properties are not tracked. Hosts without the
+ * macro pay nothing.
+ */
+
+#include "property_impl.hpp"
+#include "reflection.hpp"
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Only call in class scope, after all the properties to track.
+#define LIBPROPERTY_DIRTY_TRACKING(host)                                       \
+  friend struct ::libproperty::impl::access;                                   \
+  mutable ::libproperty::dirty_bits<LIBPROPERTY__PROPERTIES_SO_FAR()::size>    \
+      _libproperty__dirty;                                                     \
+  static_assert(true, "require semicolon")
+
+namespace libproperty {
+
+/// `N` bits, in as few bytes as will hold them.
+template <std::size_t N>
+class dirty_bits {
+  static_assert(
+      N > 0, "declare LIBPROPERTY_DIRTY_TRACKING after the properties");
+
+  // clang-format off
+  using word = std::conditional_t<N <= 8, std::uint8_t,
+               std::conditional_t<N <= 16, std::uint16_t,
+               std::conditional_t<N <= 32, std::uint32_t,
+               std::uint64_t>>>;
+  // clang-format on
+  static constexpr std::size_t word_bits = sizeof(word) * CHAR_BIT;
+  static constexpr std::size_t words = (N + word_bits - 1) / word_bits;
+
+  word bits_[words] = {};
+
+public:
+  static constexpr std::size_t size() noexcept
+  {
+    return N;
+  }
+
+  constexpr bool test(std::size_t i) const noexcept
+  {
+    return (bits_[i / word_bits] >> (i % word_bits)) & 1u;
+  }
+  constexpr void set(std::size_t i) noexcept
+  {
+    bits_[i / word_bits] |= static_cast<word>(word{ 1 } << (i % word_bits));
+  }
+  constexpr void reset(std::size_t i) noexcept
+  {
+    bits_[i / word_bits] &= static_cast<word>(~(word{ 1 } << (i % word_bits)));
+  }
+  constexpr bool any() const noexcept
+  {
+    for (auto w : bits_) {
+      if (w != 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+  constexpr std::size_t count() const noexcept
+  {
+    std::size_t n = 0;
+    for (auto w : bits_) {
+      for (; w != 0; w &= static_cast<word>(w - 1)) {
+        ++n;
+      }
+    }
+    return n;
+  }
+  constexpr void clear() noexcept
+  {
+    for (auto& w : bits_) {
+      w = 0;
+    }
+  }
+};
+
+/// The dirty bits of `host`, indexed by declaration order.
+template <typename Host>
+constexpr auto& dirty(Host const& host) noexcept
+{
+  return impl::access::dirty(host);
+}
+
+/// Whether `host.*member` has been written since the bits were cleared.
+template <typename Host, typename Property>
+constexpr bool is_dirty(Host const& host, Property Host::*member) noexcept
+{
+  static_cast<void>(member);
+  using tag = impl::tag_type<Property>;
+  static_assert(impl::property_index<tag>::value
+          < impl::dirty_bits_t<Host>::size(),
+      "declare LIBPROPERTY_DIRTY_TRACKING after all properties");
+  return dirty(host).test(impl::property_index<tag>::value);
+}
+
+template <typename Host>
+constexpr void clear_dirty(Host const& host) noexcept
+{
+  dirty(host).clear();
+}
+
+namespace impl {
+  template <typename List>
+  struct dirty_visitor;
+  template <typename... Tags>
+  struct dirty_visitor<tag_list<Tags...>> {
+    template <typename Host, typename Bits, typename F>
+    static constexpr void visit(Host&& host, Bits const& bits, F&& f)
+    {
+      std::size_t i = 0;
+      ((bits.test(i++) ? static_cast<void>(f(
+                             LIBPROPERTY__FORWARD(host).*Tags::member(),
+                             property_info<Tags>{}))
+                       : static_cast<void>(0)),
+          ...);
+    }
+  };
+} // impl
+
+/**
+ * Calls `f(property, info)`, like `for_each_property`, for the dirty
+ * properties of `host` only, in declaration order.
+ */
+template <typename Host, typename F>
+constexpr void for_each_dirty(Host&& host, F&& f)
+{
+  using tags = impl::properties_t<std::decay_t<Host>>;
+  static_assert(tags::size == impl::dirty_bits_t<std::decay_t<Host>>::size(),
+      "declare LIBPROPERTY_DIRTY_TRACKING after all properties");
+  auto const& bits = dirty(host);
+  if (bits.any()) {
+    impl::dirty_visitor<tags>::visit(
+        LIBPROPERTY__FORWARD(host), bits, LIBPROPERTY__FORWARD(f));
+  }
+}
+
+} // libproperty
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef INCLUDED_LIBPROPERTY_HOST_ACCESS_HPP
+#define INCLUDED_LIBPROPERTY_HOST_ACCESS_HPP
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015, 2017 Gašper Ažman
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/*
+ * Property access through the host: `get(host, &Host::prop)` and
+ * `set(host, &Host::prop, x)`.
+ *
+ * `host.prop` has to find the host from the address of the property, which
+ * takes a `reinterpret_cast` and so cannot happen in a constant expression.
+ * These start from the host instead, and are `constexpr` whenever the getter
+ * or setter is. At runtime they compile to the same code as `host.prop`.
+ */
+
+#include "property_impl.hpp"
+#include "rw_property.hpp"
+#include "wrapper.hpp"
+
+#include <type_traits>
+#include <utility>
+
+namespace libproperty {
+
+namespace impl {
+  template <typename Host>
+  using host_of_t = std::remove_cv_t<std::remove_reference_t<Host>>;
+} // impl
+
+/// What reading `host.*member` returns.
+template <typename Host, typename Property>
+LIBPROPERTY__ACCESSOR constexpr auto get(
+    Host&& host, Property impl::host_of_t<Host>::*member) -> decltype(auto)
+{
+  namespace pi = ::libproperty::impl;
+  constexpr auto kind = property_traits<Property>::kind;
+  if constexpr (kind == property_kind::rw_property) {
+    static_cast<void>(member);
+    using meta = pi::meta_type<Property>;
+    if constexpr (std::is_lvalue_reference_v<Host>) {
+      return pi::invoke<meta::getter>(std::as_const(host));
+    } else {
+      return pi::invoke<meta::move_getter>(LIBPROPERTY__FORWARD(host));
+    }
+  } else if constexpr (kind == property_kind::bitfield) {
+    static_cast<void>(member);
+    return pi::access::bits<Property>(host);
+  } else {
+    static_assert(kind == property_kind::wrapper,
+        "memoized properties cannot be read through the host");
+    return pi::access::value(host.*member).get(LIBPROPERTY__FORWARD(host));
+  }
+}
+
+/// What `host.*member = x` does.
+template <typename Host, typename Property, typename X>
+LIBPROPERTY__ACCESSOR constexpr auto set(
+    Host&& host, Property impl::host_of_t<Host>::*member, X&& x)
+    -> decltype(auto)
+{
+  namespace pi = ::libproperty::impl;
+  constexpr auto kind = property_traits<Property>::kind;
+  [[maybe_unused]] auto const written
+      = pi::invalidate_after_write<Property>(host);
+  if constexpr (kind == property_kind::rw_property) {
+    static_cast<void>(member);
+    return pi::invoke<pi::meta_type<Property>::setter>(
+        LIBPROPERTY__FORWARD(host), LIBPROPERTY__FORWARD(x));
+  } else if constexpr (kind == property_kind::bitfield) {
+    static_cast<void>(member);
+    pi::access::set_bits<Property>(host, x);
+  } else {
+    static_assert(kind == property_kind::wrapper,
+        "memoized properties cannot be assigned to");
+    return pi::access::value(host.*member).set(
+        LIBPROPERTY__FORWARD(host), LIBPROPERTY__FORWARD(x));
+  }
+}
+
+} // libproperty
+
+#endif
@@ -0,0 +1,294 @@
+#ifndef INCLUDED_LIBPROPERTY_INSTRUMENT_HPP
+#define INCLUDED_LIBPROPERTY_INSTRUMENT_HPP
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015, 2017 Gašper Ažman
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/*
+ * Access counters for every property, for finding the hot ones.
+ *
+ * Off unless LIBPROPERTY_INSTRUMENT (or LIBPROPERTY_INSTRUMENT_LATENCY) is
+ * defined, in which case every read and write of a property through
+ * `host.prop` is counted, and with LIBPROPERTY_INSTRUMENT_LATENCY also timed
+ * into a histogram. Off, the probes are empty objects and the accessors
+ * compile to exactly what they do without this header (see codegen.cpp).
+ *
+ * The counters are kept per thread and per property, so the hot path only
+ * writes to memory of its own thread. `instrumentation_report()` sums them up
+ * across threads, including those that have exited.
+ */
+
+#include "config.hpp"
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <typeindex>
+#include <vector>
+
+#ifdef LIBPROPERTY_INSTRUMENT
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <typeinfo>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace libproperty {
+
+/// The counts of one property, summed over all threads.
+struct property_stats {
+  /// Bucket `i` counts the accesses that took [2^(i-1), 2^i) ticks.
+  using histogram = std::array<std::uint64_t, 64>;
+
+  std::type_index host;
+  std::string_view property;
+  std::uint64_t reads = 0;
+  std::uint64_t writes = 0;
+  // all zero without LIBPROPERTY_INSTRUMENT_LATENCY
+  histogram read_latency = {};
+  histogram write_latency = {};
+};
+
+namespace impl {
+
+  enum class access_kind { read, write };
+
+#ifdef LIBPROPERTY_INSTRUMENT
+
+  /// A counter that only its own thread writes to, and anyone may read.
+  class shard_counter {
+    std::atomic<std::uint64_t> count_{ 0 };
+
+  public:
+    void bump() noexcept
+    {
+      // not an atomic increment: there is only one writer
+      auto const count = count_.load(std::memory_order_relaxed);
+      count_.store(count + 1, std::memory_order_relaxed);
+    }
+    std::uint64_t load() const noexcept
+    {
+      return count_.load(std::memory_order_relaxed);
+    }
+  };
+
+  /// Guards the shards of a site. A spin lock, because shards register
+  /// themselves inside noexcept accessors, where nothing may throw.
+  class site_lock {
+    std::atomic_flag locked_ = ATOMIC_FLAG_INIT;
+
+  public:
+    void lock() noexcept
+    {
+      while (locked_.test_and_set(std::memory_order_acquire)) {
+      }
+    }
+    void unlock() noexcept
+    {
+      locked_.clear(std::memory_order_release);
+    }
+  };
+
+  struct probe_shard;
+
+  /// One per instrumented property, linked into a global list.
+  struct probe_site {
+    std::type_index host;
+    std::string_view property;
+    site_lock lock; // guards shards and retired
+    probe_shard* shards = nullptr; // intrusive, so registering never allocates
+    property_stats retired;
+    probe_site* next = nullptr;
+
+    probe_site(std::type_index h, std::string_view p)
+        : host(h)
+        , property(p)
+        , retired{ h, p }
+    {
+      auto& head = sites();
+      next = head.load(std::memory_order_relaxed);
+      while (!head.compare_exchange_weak(
+          next, this, std::memory_order_release, std::memory_order_relaxed)) {
+      }
+    }
+
+    static std::atomic<probe_site*>& sites() noexcept
+    {
+      static std::atomic<probe_site*> head{ nullptr };
+      return head;
+    }
+  };
+
+  /// The counters of one property in one thread. It is constructed on the
+  /// first access of its thread, inside the accessor, so nothing in here
+  /// allocates or throws.
+  struct probe_shard {
+    probe_site& site;
+    probe_shard* prev = nullptr;
+    probe_shard* next = nullptr;
+    shard_counter counts[2];
+#ifdef LIBPROPERTY_INSTRUMENT_LATENCY
+    shard_counter latency[2][std::tuple_size_v<property_stats::histogram>];
+#endif
+
+    explicit probe_shard(probe_site& s) noexcept
+        : site(s)
+    {
+      std::lock_guard<site_lock> const lock{ site.lock };
+      next = site.shards;
+      if (next != nullptr) {
+        next->prev = this;
+      }
+      site.shards = this;
+    }
+    probe_shard(probe_shard const&) = delete;
+    probe_shard& operator=(probe_shard const&) = delete;
+    ~probe_shard()
+    {
+      std::lock_guard<site_lock> const lock{ site.lock };
+      add_to(site.retired);
+      (prev != nullptr ? prev->next : site.shards) = next;
+      if (next != nullptr) {
+        next->prev = prev;
+      }
+    }
+
+    void add_to(property_stats& stats) const noexcept
+    {
+      stats.reads += counts[0].load();
+      stats.writes += counts[1].load();
+#ifdef LIBPROPERTY_INSTRUMENT_LATENCY
+      for (std::size_t i = 0; i < stats.read_latency.size(); ++i) {
+        stats.read_latency[i] += latency[0][i].load();
+        stats.write_latency[i] += latency[1][i].load();
+      }
+#endif
+    }
+  };
+
+  template <typename Tag>
+  probe_site& site_of()
+  {
+    static probe_site site{ typeid(typename Tag::host_type),
+      Tag::property_name() };
+    return site;
+  }
+  template <typename Tag>
+  probe_shard& shard_of()
+  {
+    thread_local probe_shard shard{ site_of<Tag>() };
+    return shard;
+  }
+
+  /// Cycles where there is a cheap counter for them, else nanoseconds.
+  inline std::uint64_t ticks() noexcept
+  {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(
+        std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+  }
+
+  inline std::size_t latency_bucket(std::uint64_t ticks) noexcept
+  {
+    std::size_t bucket = 0;
+    for (; ticks != 0; ticks >>= 1) {
+      ++bucket;
+    }
+    return std::min(bucket, std::tuple_size_v<property_stats::histogram> - 1);
+  }
+
+  /// Counts (and times) the access it is alive for.
+  template <typename Tag, access_kind Kind>
+  class probe {
+#ifdef LIBPROPERTY_INSTRUMENT_LATENCY
+    std::uint64_t start_ = ticks();
+#endif
+
+  public:
+    probe() = default;
+    probe(probe const&) = delete;
+    probe& operator=(probe const&) = delete;
+    ~probe()
+    {
+      auto& shard = shard_of<Tag>();
+      shard.counts[static_cast<int>(Kind)].bump();
+#ifdef LIBPROPERTY_INSTRUMENT_LATENCY
+      shard.latency[static_cast<int>(Kind)][latency_bucket(ticks() - start_)]
+          .bump();
+#endif
+    }
+  };
+
+#else
+
+  template <typename Tag, access_kind Kind>
+  struct probe {
+  };
+
+#endif
+
+} // impl
+
+/**
+ * The counts of every property that has been accessed, by host and property
+ * name. Empty if instrumentation is off.
+ */
+inline std::vector<property_stats> instrumentation_report()
+{
+  std::vector<property_stats> report;
+#ifdef LIBPROPERTY_INSTRUMENT
+  auto* site = impl::probe_site::sites().load(std::memory_order_acquire);
+  for (; site != nullptr; site = site->next) {
+    std::lock_guard<impl::site_lock> const lock{ site->lock };
+    property_stats stats = site->retired;
+    for (auto const* shard = site->shards; shard != nullptr;
+         shard = shard->next) {
+      shard->add_to(stats);
+    }
+    report.push_back(stats);
+  }
+#endif
+  return report;
+}
+
+/// Writes `host.property reads writes`, one property per line.
+inline void write_instrumentation_report(std::ostream& out)
+{
+  for (auto const& stats : instrumentation_report()) {
+    out << stats.host.name() << '.' << stats.property << ' ' << stats.reads
+        << ' ' << stats.writes << '\n';
+  }
+}
+
+} // libproperty
+
+#endif
@@ -0,0 +1,612 @@
+#ifndef INCLUDED_LIBPROPERTY_JOURNAL_HPP
+#define INCLUDED_LIBPROPERTY_JOURNAL_HPP
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015, 2017 Gašper Ažman
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/*
+ * A change journal: every write to a journaled property appends a record of
+ * it to a buffer owned by the writing thread, and a background thread writes
+ * the full buffers to a file, so setters never wait for the disk. Replaying
+ * the file into fresh hosts brings them to the state the journal recorded,
+ * for crash recovery or auditing.
+ *
+ *   libproperty::journal log("orders.journal"); // records until destroyed
+ *   o.price = 10;                                  // appended, not written
+ *   ...
+ *   libproperty::replay("orders.journal", [&](std::uint64_t id) {
+ *     return &orders[id];
+ *   });
+ *
+ * Only values of trivially copyable types are journaled, as their bytes, so a
+ * journal can only be replayed by the same build on the same platform.
+ */
+
+#include "config.hpp"
+#include "meta.hpp"
+#include "property_impl.hpp"
+#include "wrapper.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// A wrapped property whose writes are recorded in the current journal.
+#define LIBPROPERTY_JOURNALED(type, name, host)                                \
+  LIBPROPERTY_WRAP((::libproperty::journaled<LIBPROPERTY__PARENTHESIZED_TYPE   \
+                       type,                                                   \
+                       host::LIBPROPERTY__TAG_NAME(name)>),                    \
+      name,                                                                    \
+      host)
+
+// Optional: `host.id()` names the host in journal records, so that a replay in
+// another process can tell which host a record is for. Without it, records
+// name hosts by their address. Only call in class scope.
+#define LIBPROPERTY_JOURNAL_ID(id, host)                                       \
+  static ::std::uint64_t _libproperty__journal_id(host const& h)               \
+  {                                                                            \
+    return static_cast<::std::uint64_t>(h.id());                               \
+  }                                                                            \
+  static_assert(true, "require semicolon")
+
+namespace libproperty {
+
+/// What precedes the `size` bytes of each value in a journal file.
+struct journal_record {
+  std::uint64_t host;
+  /// The declaration index of the property in its host.
+  std::uint32_t property;
+  std::uint32_t size;
+};
+static_assert(sizeof(journal_record) == 16);
+
+class journal;
+
+namespace impl {
+  /**
+   * The buffer a thread appends its records to. Its lock is only ever
+   * contended by the flusher, when it collects a buffer that is not full yet.
+   */
+  struct journal_arena {
+    std::mutex mutex;
+    std::atomic<journal*> owner{ nullptr };
+    std::vector<char> block;
+
+    ~journal_arena();
+
+    static journal_arena& mine()
+    {
+      thread_local journal_arena arena;
+      return arena;
+    }
+  };
+
+  template <typename Host>
+  using journal_id_hook_t
+      = decltype(Host::_libproperty__journal_id(std::declval<Host const&>()));
+
+  template <typename List>
+  struct journal_replay;
+} // impl
+
+/// The id records of writes to `host` carry.
+template <typename Host>
+std::uint64_t journal_id(Host const& host) noexcept
+{
+  if constexpr (meta::is_detected_v<impl::journal_id_hook_t, Host>) {
+    return Host::_libproperty__journal_id(host);
+  } else {
+    return reinterpret_cast<std::uintptr_t>(LIBPROPERTY__ADDRESSOF(host));
+  }
+}
+
+/**
+ * Appends the records of all threads to a file, in blocks of `block_size`
+ * bytes, as each thread fills one; and every `interval`, also the blocks that
+ * are not full yet. Journaled properties record their writes in the current
+ * journal, the one most recently created and not destroyed. There may only be
+ * one at a time.
+ *
+ * The journal must outlive the threads that write to it, and be closed or
+ * destroyed after they stop writing; either writes out everything they
+ * recorded. Once a write to the file fails, nothing more is written, and
+ * `append`, `flush` and `close` throw the error; the destructor cannot, so
+ * call `close` to learn whether the whole journal made it to the file.
+ * Records of one thread are written in the order they were made; records of
+ * different threads are not ordered with respect to one another.
+ */
+class journal {
+  friend struct impl::journal_arena;
+
+  inline static std::atomic<journal*> current_{ nullptr };
+  // written blocks kept for reuse
+  static constexpr std::size_t max_free_blocks = 16;
+
+  std::FILE* file_;
+  std::size_t block_size_;
+  std::chrono::milliseconds interval_;
+
+  // lock order: arenas_mutex_, then an arena's, then mutex_
+  std::mutex arenas_mutex_;
+  std::vector<impl::journal_arena*> arenas_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable written_;
+  std::vector<std::vector<char>> full_;
+  std::vector<std::vector<char>> free_;
+  std::uint64_t requested_ = 0;
+  std::uint64_t done_ = 0;
+  bool stop_ = false;
+  bool closed_ = false;
+  // the errno of the first failed write; nothing is written after it
+  std::atomic<int> error_{ 0 };
+
+  std::thread flusher_;
+
+  void attach(impl::journal_arena& arena)
+  {
+    std::lock_guard<std::mutex> arenas_lock{ arenas_mutex_ };
+    std::lock_guard<std::mutex> arena_lock{ arena.mutex };
+    arena.block.clear();
+    arena.block.reserve(block_size_);
+    arenas_.push_back(&arena);
+    arena.owner.store(this, std::memory_order_relaxed);
+  }
+
+  void retire(impl::journal_arena& arena)
+  {
+    {
+      std::lock_guard<std::mutex> arenas_lock{ arenas_mutex_ };
+      std::lock_guard<std::mutex> arena_lock{ arena.mutex };
+      if (!arena.block.empty()) {
+        hand_off(arena.block, false);
+      }
+      arenas_.erase(std::find(arenas_.begin(), arenas_.end(), &arena));
+      arena.owner.store(nullptr, std::memory_order_relaxed);
+    }
+    wake_.notify_one();
+  }
+
+  /// Queues `block` for writing, and replaces it with an empty one.
+  void hand_off(std::vector<char>& block, bool wanted)
+  {
+    std::vector<char> fresh;
+    {
+      std::lock_guard<std::mutex> lock{ mutex_ };
+      full_.push_back(std::move(block));
+      if (!free_.empty()) {
+        fresh = std::move(free_.back());
+        free_.pop_back();
+      }
+    }
+    if (wanted) {
+      fresh.reserve(block_size_);
+    }
+    block = std::move(fresh);
+  }
+
+  /// Queues the blocks of all threads, full or not.
+  void collect()
+  {
+    std::lock_guard<std::mutex> arenas_lock{ arenas_mutex_ };
+    for (auto* arena : arenas_) {
+      std::lock_guard<std::mutex> arena_lock{ arena->mutex };
+      if (!arena->block.empty()) {
+        hand_off(arena->block, true);
+      }
+    }
+  }
+
+  void fail() noexcept
+  {
+    int expected = 0;
+    error_.compare_exchange_strong(expected, errno != 0 ? errno : EIO);
+  }
+
+  /// Writes `batch` out, unless an earlier write failed.
+  void write(std::vector<std::vector<char>> const& batch) noexcept
+  {
+    if (error_.load(std::memory_order_relaxed) != 0) {
+      return;
+    }
+    errno = 0;
+    for (auto const& block : batch) {
+      if (std::fwrite(block.data(), 1, block.size(), file_) != block.size()) {
+        fail();
+        return;
+      }
+    }
+    if (std::fflush(file_) != 0) {
+      fail();
+    }
+  }
+
+  void check() const
+  {
+    if (auto const e = error_.load(std::memory_order_relaxed)) {
+      throw std::system_error(
+          e, std::generic_category(), "libproperty journal");
+    }
+  }
+
+  /// Stops the flusher once it has written everything, and closes the file.
+  void stop() noexcept
+  {
+    if (closed_) {
+      return;
+    }
+    closed_ = true;
+    journal* self = this;
+    current_.compare_exchange_strong(self, nullptr);
+    {
+      std::lock_guard<std::mutex> lock{ mutex_ };
+      stop_ = true;
+    }
+    wake_.notify_one();
+    flusher_.join();
+    {
+      std::lock_guard<std::mutex> arenas_lock{ arenas_mutex_ };
+      for (auto* arena : arenas_) {
+        std::lock_guard<std::mutex> arena_lock{ arena->mutex };
+        arena->block = std::vector<char>();
+        arena->owner.store(nullptr, std::memory_order_relaxed);
+      }
+      arenas_.clear();
+    }
+    errno = 0;
+    if (std::fclose(file_) != 0) {
+      fail();
+    }
+  }
+
+  void run()
+  {
+    std::unique_lock<std::mutex> lock{ mutex_ };
+    for (;;) {
+      bool const timed_out = !wake_.wait_for(lock, interval_, [&] {
+        return stop_ || !full_.empty() || requested_ != done_;
+      });
+      auto const target = requested_;
+      bool const stopping = stop_;
+      if (timed_out || target != done_ || stopping) {
+        lock.unlock();
+        collect();
+        lock.lock();
+      }
+      auto batch = std::move(full_);
+      full_.clear();
+      lock.unlock();
+
+      write(batch);
+
+      lock.lock();
+      for (auto& block : batch) {
+        if (free_.size() < max_free_blocks) {
+          block.clear();
+          free_.push_back(std::move(block));
+        }
+      }
+      done_ = target;
+      written_.notify_all();
+      if (stopping) {
+        return;
+      }
+    }
+  }
+
+public:
+  static constexpr std::size_t default_block_size = 64 * 1024;
+
+  /**
+   * Appends to the file at `path`, creating it if need be. Throws
+   * std::system_error if it cannot be opened, and std::logic_error if there
+   * already is a current journal.
+   */
+  explicit journal(char const* path,
+      std::chrono::milliseconds interval = std::chrono::milliseconds(10),
+      std::size_t block_size = default_block_size)
+      : file_(std::fopen(path, "ab"))
+      , block_size_(block_size)
+      , interval_(interval)
+  {
+    if (file_ == nullptr) {
+      throw std::system_error(errno, std::generic_category(), path);
+    }
+    journal* none = nullptr;
+    if (!current_.compare_exchange_strong(none, this)) {
+      std::fclose(file_);
+      throw std::logic_error("libproperty journal: one is already open");
+    }
+    flusher_ = std::thread([this] { run(); });
+  }
+  journal(journal const&) = delete;
+  journal& operator=(journal const&) = delete;
+  /// Writes out what is left; call `close` first to learn whether it could.
+  ~journal()
+  {
+    stop();
+  }
+
+  /**
+   * Writes out everything recorded so far and closes the file; the journal
+   * is no longer current. Throws std::system_error if any write failed.
+   */
+  void close()
+  {
+    stop();
+    check();
+  }
+
+  /// The first error writing the file, if any.
+  std::error_code error() const noexcept
+  {
+    return { error_.load(std::memory_order_relaxed), std::generic_category() };
+  }
+
+  /// The journal that journaled properties record their writes in, if any.
+  static journal* current() noexcept
+  {
+    return current_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * Appends a record to this thread's block. Throws std::system_error once a
+   * write has failed: the journal would have a hole from then on.
+   */
+  void append(std::uint64_t host,
+      std::uint32_t property,
+      void const* bytes,
+      std::uint32_t size)
+  {
+    check();
+    auto& arena = impl::journal_arena::mine();
+    if (arena.owner.load(std::memory_order_relaxed) != this) {
+      attach(arena);
+    }
+    journal_record const record{ host, property, size };
+    std::lock_guard<std::mutex> lock{ arena.mutex };
+    auto& block = arena.block;
+    auto const used = block.size();
+    if (used != 0 && used + sizeof(record) + size > block_size_) {
+      hand_off(block, true);
+      wake_.notify_one();
+    }
+    auto const at = block.size();
+    block.resize(at + sizeof(record) + size);
+    std::memcpy(block.data() + at, &record, sizeof(record));
+    std::memcpy(block.data() + at + sizeof(record), bytes, size);
+  }
+
+  /**
+   * Writes out everything recorded so far, by any thread, and waits for it.
+   * Throws std::system_error if a write failed.
+   */
+  void flush()
+  {
+    {
+      std::unique_lock<std::mutex> lock{ mutex_ };
+      auto const target = ++requested_;
+      wake_.notify_one();
+      written_.wait(lock, [&] { return done_ >= target; });
+    }
+    check();
+  }
+};
+
+inline impl::journal_arena::~journal_arena()
+{
+  if (auto* const j = owner.load(std::memory_order_relaxed)) {
+    j->retire(*this);
+  }
+}
+
+/**
+ * `wrapper` policy that records every write in the current journal, if there
+ * is one, after making it. Takes the property's tag, which the record names
+ * it by; LIBPROPERTY_JOURNALED supplies it.
+ */
+template <typename T, typename Tag>
+class journaled {
+  static_assert(std::is_trivially_copyable_v<T>,
+      "journaled values are recorded as their bytes");
+
+  template <typename List>
+  friend struct impl::journal_replay;
+
+  T value_;
+
+  template <typename Host>
+  void record(Host const& host) const
+  {
+    if (auto* const j = journal::current()) {
+      j->append(journal_id(host),
+          impl::property_index<Tag>::value,
+          LIBPROPERTY__ADDRESSOF(value_),
+          sizeof(T));
+    }
+  }
+
+public:
+  using value_type = T;
+
+  template <typename... Args,
+      typename = std::enable_if_t<std::is_constructible_v<T, Args&&...>>>
+  constexpr journaled(Args&&... args)
+      : value_(LIBPROPERTY__FORWARD(args)...)
+  {
+  }
+
+  /* the wrapper protocol */
+  template <typename Host>
+  T const& get(Host const&) const noexcept
+  {
+    return value_;
+  }
+  template <typename Host,
+      typename X,
+      typename = std::enable_if_t<std::is_assignable_v<T&, X&&>>>
+  void set(Host const& host, X&& x)
+  {
+    value_ = LIBPROPERTY__FORWARD(x);
+    record(host);
+  }
+  /// One record for the whole modification.
+  template <typename Host, typename F>
+  decltype(auto) modify(Host const& host, F&& f)
+  {
+    if constexpr (std::is_void_v<std::invoke_result_t<F&&, T&>>) {
+      LIBPROPERTY__FORWARD(f)(value_);
+      record(host);
+    } else {
+      auto result = LIBPROPERTY__FORWARD(f)(value_);
+      record(host);
+      return result;
+    }
+  }
+};
+
+template <typename T>
+struct is_journaled : std::false_type {
+};
+template <typename T, typename Tag>
+struct is_journaled<journaled<T, Tag>> : std::true_type {
+};
+
+namespace impl {
+  template <typename... Tags>
+  struct journal_replay<tag_list<Tags...>> {
+    template <typename Tag, typename Host>
+    static bool restore(Host& host, char const* bytes, std::uint32_t size)
+    {
+      if constexpr (is_journaled<storage_t<Tag>>::value) {
+        auto& policy = access::value(host.*Tag::member());
+        if (size != sizeof(policy.value_)) {
+          return false;
+        }
+        using property = std::remove_reference_t<decltype(host.*Tag::member())>;
+        [[maybe_unused]] auto const written
+            = invalidate_after_write<property>(host);
+        std::memcpy(LIBPROPERTY__ADDRESSOF(policy.value_), bytes, size);
+        return true;
+      } else {
+        static_cast<void>(host);
+        static_cast<void>(bytes);
+        static_cast<void>(size);
+        return false;
+      }
+    }
+
+    template <typename Host>
+    static bool apply(Host& host,
+        std::uint32_t property,
+        char const* bytes,
+        std::uint32_t size)
+    {
+      std::uint32_t i = 0;
+      return ((i++ == property && restore<Tags>(host, bytes, size)) || ...);
+    }
+  };
+} // impl
+
+/**
+ * Replays the journal file at `path`, in order, into the hosts that
+ * `resolve(id)` returns for the ids in its records: each record sets the
+ * value of the journaled property it names, without recording it again.
+ * Records for which `resolve` returns a null pointer, or that do not name a
+ * journaled property of the host, are skipped; so are the ids of hosts of
+ * other types, which must therefore not collide with those of this one. A
+ * record cut short at the end of the file, as a crash leaves it, or one
+ * whose size runs past the end of the file, ends the replay.
+ *
+ * Values are copied into the properties' storage as bytes: no setter, policy
+ * or observer runs. The properties are marked dirty and their memoized
+ * dependents invalidated, as for any write.
+ *
+ * Returns the number of records applied. Throws std::system_error if the
+ * file cannot be opened or its length read.
+ */
+template <typename Resolve>
+std::size_t replay(char const* path, Resolve&& resolve)
+{
+  using host_ptr = std::invoke_result_t<Resolve&, std::uint64_t>;
+  using host = std::remove_pointer_t<host_ptr>;
+  static_assert(std::is_pointer_v<host_ptr>, "resolve must return a pointer");
+
+  std::unique_ptr<std::FILE, int (*)(std::FILE*)> file(
+      std::fopen(path, "rb"), &std::fclose);
+  if (!file) {
+    throw std::system_error(errno, std::generic_category(), path);
+  }
+  // the size in a record is only trusted up to what is left of the file
+  long length = -1;
+  if (std::fseek(file.get(), 0, SEEK_END) == 0) {
+    length = std::ftell(file.get());
+  }
+  if (length < 0 || std::fseek(file.get(), 0, SEEK_SET) != 0) {
+    throw std::system_error(errno, std::generic_category(), path);
+  }
+  auto left = static_cast<std::uint64_t>(length);
+
+  std::size_t applied = 0;
+  std::vector<char> bytes;
+  journal_record record;
+  while (std::fread(&record, sizeof(record), 1, file.get()) == 1) {
+    left -= std::min<std::uint64_t>(left, sizeof(record));
+    if (record.size > left) {
+      break;
+    }
+    left -= record.size;
+    bytes.resize(record.size);
+    if (std::fread(bytes.data(), 1, record.size, file.get()) != record.size) {
+      break;
+    }
+    if (host* const h = resolve(record.host)) {
+      using tags = impl::properties_t<std::remove_cv_t<host>>;
+      if (impl::journal_replay<tags>::apply(
+              *h, record.property, bytes.data(), record.size)) {
+        ++applied;
+      }
+    }
+  }
+  return applied;
+}
+
+} // libproperty
+
+#endif
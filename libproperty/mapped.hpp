@@ -0,0 +1,236 @@
+#ifndef INCLUDED_LIBPROPERTY_MAPPED_HPP
+#define INCLUDED_LIBPROPERTY_MAPPED_HPP
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015, 2017 Gašper Ažman
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/*
+ * Hosts that live in a memory-mapped file and survive being mapped at another
+ * address: `offset_ptr`, a pointer that stores where it points relative to
+ * itself, and `mapped_arena`, which allocates hosts in a mapped region.
+ *
+ * Properties themselves are relocatable: `impl::get_host` finds the host at a
+ * constant offset from the property, not through a stored address. What does
+ * not relocate is any value holding an absolute address, such as `T*` or
+ * `std::string`; use `offset_ptr` and fixed-size values instead. Striped
+ * properties hash the host's address, which is fine, since their locks are not
+ * persisted.
+ */
+
+#include "config.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace libproperty {
+
+/**
+ * A pointer to `T` stored as the distance from itself to the pointee, so that
+ * it stays valid when the memory holding both is moved or mapped elsewhere.
+ * Copying it points the copy at the same object. It cannot point to itself:
+ * an offset of 0 is the null pointer.
+ */
+template <typename T>
+class offset_ptr {
+  std::ptrdiff_t offset_ = 0;
+
+  std::ptrdiff_t offset_to(T* p) const noexcept
+  {
+    return p ? reinterpret_cast<char const*>(p)
+            - reinterpret_cast<char const*>(this)
+             : 0;
+  }
+
+public:
+  using element_type = T;
+
+  constexpr offset_ptr() noexcept = default;
+  constexpr offset_ptr(std::nullptr_t) noexcept
+  {
+  }
+  offset_ptr(T* p) noexcept : offset_(offset_to(p))
+  {
+  }
+  offset_ptr(offset_ptr const& other) noexcept : offset_(offset_to(other.get()))
+  {
+  }
+  offset_ptr& operator=(offset_ptr const& other) noexcept
+  {
+    offset_ = offset_to(other.get());
+    return *this;
+  }
+  offset_ptr& operator=(T* p) noexcept
+  {
+    offset_ = offset_to(p);
+    return *this;
+  }
+
+  T* get() const noexcept
+  {
+    if (offset_ == 0) {
+      return nullptr;
+    }
+    auto const self = const_cast<char*>(reinterpret_cast<char const*>(this));
+    return reinterpret_cast<T*>(self + offset_);
+  }
+  T& operator*() const noexcept
+  {
+    return *get();
+  }
+  T* operator->() const noexcept
+  {
+    return get();
+  }
+  explicit operator bool() const noexcept
+  {
+    return offset_ != 0;
+  }
+
+  friend bool operator==(offset_ptr const& x, offset_ptr const& y) noexcept
+  {
+    return x.get() == y.get();
+  }
+  friend bool operator!=(offset_ptr const& x, offset_ptr const& y) noexcept
+  {
+    return x.get() != y.get();
+  }
+};
+
+struct arena_error : std::runtime_error {
+  using std::runtime_error::runtime_error;
+};
+
+/**
+ * A bump allocator for hosts in a region of memory, typically a mapped file,
+ * that keeps its bookkeeping in the region itself. `create` formats a region,
+ * and `open` picks up one that was formatted before, possibly at another
+ * address, for example after a restart.
+ *
+ * Objects are never freed; they have to be trivially destructible, and must
+ * only refer to each other through `offset_ptr`. `root` is where to find them
+ * again after `open`. Not thread-safe.
+ */
+class mapped_arena {
+  struct header {
+    char magic[8];
+    std::uint64_t size;
+    std::uint64_t used;
+    std::uint64_t root; // offset from the region, 0 if unset
+  };
+  static constexpr char magic[8] = { 'L', 'I', 'B', 'P', 'A', 'R', 'N', '1' };
+
+  char* region_;
+
+  explicit mapped_arena(void* region) noexcept
+      : region_(static_cast<char*>(region))
+  {
+  }
+
+  header& head() const noexcept
+  {
+    return *std::launder(reinterpret_cast<header*>(region_));
+  }
+
+public:
+  /// Formats `size` bytes at `region`, which must be suitably aligned.
+  static mapped_arena create(void* region, std::size_t size)
+  {
+    if (size < sizeof(header)
+        || reinterpret_cast<std::uintptr_t>(region) % alignof(header) != 0) {
+      throw arena_error("libproperty arena: region too small or misaligned");
+    }
+    auto const h = ::new (region) header{};
+    std::memcpy(h->magic, magic, sizeof(magic));
+    h->size = size;
+    h->used = sizeof(header);
+    return mapped_arena(region);
+  }
+
+  /// Picks up the arena that `create` formatted at `region`.
+  static mapped_arena open(void* region, std::size_t size)
+  {
+    if (size < sizeof(header)
+        || reinterpret_cast<std::uintptr_t>(region) % alignof(header) != 0) {
+      throw arena_error("libproperty arena: region too small or misaligned");
+    }
+    mapped_arena arena(region);
+    if (std::memcmp(arena.head().magic, magic, sizeof(magic)) != 0
+        || arena.head().size != size || arena.head().used > size) {
+      throw arena_error("libproperty arena: not an arena of this size");
+    }
+    return arena;
+  }
+
+  std::size_t size() const noexcept
+  {
+    return static_cast<std::size_t>(head().size);
+  }
+  std::size_t used() const noexcept
+  {
+    return static_cast<std::size_t>(head().used);
+  }
+
+  /// Constructs a `T` in the arena; throws std::bad_alloc if it is full.
+  template <typename T, typename... Args>
+  T* make(Args&&... args)
+  {
+    static_assert(std::is_trivially_destructible_v<T>,
+        "objects in an arena are never destroyed");
+    auto& h = head();
+    auto const base = reinterpret_cast<std::uintptr_t>(region_);
+    auto const start
+        = (base + h.used + alignof(T) - 1) / alignof(T) * alignof(T) - base;
+    if (start + sizeof(T) > h.size) {
+      throw std::bad_alloc();
+    }
+    auto const object = ::new (region_ + start) T(std::forward<Args>(args)...);
+    h.used = start + sizeof(T);
+    return object;
+  }
+
+  /// Remembers `object`, which must be in the arena, as the root.
+  template <typename T>
+  void set_root(T* object) noexcept
+  {
+    head().root = object ? reinterpret_cast<char*>(object) - region_ : 0;
+  }
+
+  /// The object passed to `set_root`, or null.
+  template <typename T>
+  T* root() const noexcept
+  {
+    auto const offset = head().root;
+    return offset ? std::launder(reinterpret_cast<T*>(region_ + offset))
+                  : nullptr;
+  }
+};
+
+} // libproperty
+
+#endif
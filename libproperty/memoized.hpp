@@ -0,0 +1,130 @@
+#ifndef INCLUDED_LIBPROPERTY_MEMOIZED_HPP
+#define INCLUDED_LIBPROPERTY_MEMOIZED_HPP
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015, 2017 Gašper Ažman
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "property_impl.hpp"
+
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+// A read-only property whose value is `host.compute()`, computed on first read
+// and cached until invalidated. Only call in class scope!
+#define LIBPROPERTY_MEMOIZED(type, name, compute, host)                        \
+  LIBPROPERTY__DECLARE_TAG(name, host);                                        \
+  ::libproperty::memoized<LIBPROPERTY__PARENTHESIZED_TYPE type,                \
+      host::LIBPROPERTY__TAG_NAME(name)>                                       \
+      name;                                                                    \
+  auto static constexpr _libproperty__memoized_props(decltype(name)*)          \
+  {                                                                            \
+    return ::libproperty::memoized_meta<&host::compute>{};                     \
+  }                                                                            \
+  static_assert(true, "require semicolon")
+
+// Writes to the property `name` (an rw_property or a wrapper) invalidate the
+// memoized properties given as `&host::memo, ...`. Only call in class scope,
+// after `name`.
+#define LIBPROPERTY_INVALIDATES(name, host, ...)                               \
+  auto static constexpr _libproperty__invalidates(decltype(name)*)             \
+  {                                                                            \
+    return ::libproperty::impl::dependents<__VA_ARGS__>{};                     \
+  }                                                                            \
+  static_assert(true, "require semicolon")
+
+namespace libproperty {
+
+template <auto Compute>
+struct memoized_meta {
+  static constexpr auto compute = Compute;
+};
+
+/**
+ * A read-only property that caches what the host's `compute` returns.
+ *
+ * The cache is the property's storage: an empty `value` means it is stale.
+ * Assigning to a property declared with LIBPROPERTY_INVALIDATES empties it;
+ * anything else `compute` depends on must call `invalidate()` itself when it
+ * changes.
+ *
+ * Not thread-safe: reading fills the cache.
+ */
+template <typename T, typename Tag>
+class memoized {
+  using host = typename Tag::host_type;
+  using value_type = T;
+
+  // allow `host` to access self::value
+  friend host;
+  friend struct ::libproperty::impl::access;
+
+  mutable std::optional<value_type> value;
+
+  /// disallow copying for non-friend users of the class, see rw_property.
+  constexpr memoized() = default;
+  constexpr memoized(memoized const&) = default;
+  constexpr memoized(memoized&&) = default;
+  ~memoized() = default;
+  constexpr memoized& operator=(memoized const&) = default;
+  constexpr memoized& operator=(memoized&&) = default;
+
+public:
+  LIBPROPERTY__ACCESSOR constexpr operator value_type const&() const
+  {
+    namespace pi = ::libproperty::impl;
+    if (!value) {
+      value.emplace(pi::invoke<pi::meta_type<memoized>::compute>(
+          pi::get_host(*this)));
+    }
+    return *value;
+  }
+
+  /// Drop the cached value; the next read recomputes it.
+  LIBPROPERTY__ACCESSOR void invalidate() const noexcept
+  {
+    value.reset();
+  }
+
+  LIBPROPERTY__ACCESSOR constexpr bool is_cached() const noexcept
+  {
+    return value.has_value();
+  }
+};
+
+template <typename T, typename Tag>
+struct property_traits<memoized<T, Tag>> {
+  using property = memoized<T, Tag>;
+  static constexpr std::true_type is_property = {};
+  static constexpr property_kind kind = property_kind::memoized;
+  using tag = Tag;
+  using value_type = T;
+  using host = typename tag::host_type;
+  using meta = decltype(
+      host::_libproperty__memoized_props(std::declval<property*>()));
+};
+
+} // libproperty
+
+#endif
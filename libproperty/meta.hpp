@@ -1,6 +1,8 @@
 #ifndef INCLUDED_LIBPROPERTY_META_HPP
 #define INCLUDED_LIBPROPERTY_META_HPP
 
+#include "config.hpp"
+
 #include <type_traits>
 #include <utility>
 
@@ -58,10 +60,20 @@ namespace meta {
   template <typename From, typename To>
   using like_t = typename like<From, To>::type;
 
+  /// `Op<Args...>` is well-formed (the detection idiom).
+  template <typename, template <typename...> class Op, typename... Args>
+  struct detector : std::false_type {
+  };
+  template <template <typename...> class Op, typename... Args>
+  struct detector<std::void_t<Op<Args...>>, Op, Args...> : std::true_type {
+  };
+  template <template <typename...> class Op, typename... Args>
+  constexpr bool is_detected_v = detector<void, Op, Args...>::value;
+
   template <typename Like, typename T>
-  constexpr decltype(auto) forward_like(T&& t) noexcept
+  LIBPROPERTY__ACCESSOR constexpr decltype(auto) forward_like(T&& t) noexcept
   {
-    return std::forward<like_t<Like, T>>(std::forward<T>(t));
+    return static_cast<like_t<Like, T>&&>(t);
   }
 
 } // meta
@@ -0,0 +1,206 @@
+#ifndef INCLUDED_LIBPROPERTY_MODIFY_HPP
+#define INCLUDED_LIBPROPERTY_MODIFY_HPP
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015, 2017 Gašper Ažman
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/*
+ * In-place modification of properties: `modify(f)`, the compound assignment
+ * operators and increment/decrement.
+ *
+ * A property applies `f` (or an operation from `ops`) to its value in place if
+ * its host or policy provides a hook for it, and otherwise falls back to
+ * get, modify a copy, set.
+ */
+
+#include "config.hpp"
+#include "meta.hpp"
+
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace libproperty {
+namespace ops {
+
+// The operations the compound operators hand to `compound` hooks. The
+// assignment operations return nothing, so that the fallback path does not
+// have to copy anything out of its temporary. They are only invocable on
+// values that support them.
+#define LIBPROPERTY__DECLARE_ASSIGN_OP(name, op)                               \
+  struct name {                                                                \
+    template <typename T, typename U>                                          \
+    constexpr auto operator()(T& x, U&& y) const                               \
+        noexcept(noexcept(x op LIBPROPERTY__FORWARD(y)))                       \
+            ->decltype(void(x op LIBPROPERTY__FORWARD(y)))                     \
+    {                                                                          \
+      x op LIBPROPERTY__FORWARD(y);                                            \
+    }                                                                          \
+  }
+
+  LIBPROPERTY__DECLARE_ASSIGN_OP(plus_assign, +=);
+  LIBPROPERTY__DECLARE_ASSIGN_OP(minus_assign, -=);
+  LIBPROPERTY__DECLARE_ASSIGN_OP(multiplies_assign, *=);
+  LIBPROPERTY__DECLARE_ASSIGN_OP(divides_assign, /=);
+  LIBPROPERTY__DECLARE_ASSIGN_OP(modulus_assign, %=);
+  LIBPROPERTY__DECLARE_ASSIGN_OP(bit_and_assign, &=);
+  LIBPROPERTY__DECLARE_ASSIGN_OP(bit_or_assign, |=);
+  LIBPROPERTY__DECLARE_ASSIGN_OP(bit_xor_assign, ^=);
+  LIBPROPERTY__DECLARE_ASSIGN_OP(shift_left_assign, <<=);
+  LIBPROPERTY__DECLARE_ASSIGN_OP(shift_right_assign, >>=);
+#undef LIBPROPERTY__DECLARE_ASSIGN_OP
+
+  struct increment {
+    template <typename T>
+    constexpr auto operator()(T& x) const noexcept(noexcept(++x))
+        -> decltype(void(++x))
+    {
+      ++x;
+    }
+  };
+  struct decrement {
+    template <typename T>
+    constexpr auto operator()(T& x) const noexcept(noexcept(--x))
+        -> decltype(void(--x))
+    {
+      --x;
+    }
+  };
+  /// returns the old value
+  struct post_increment {
+    template <typename T>
+    constexpr auto operator()(T& x) const noexcept(noexcept(x++))
+        -> std::decay_t<decltype(x++)>
+    {
+      return x++;
+    }
+  };
+  /// returns the old value
+  struct post_decrement {
+    template <typename T>
+    constexpr auto operator()(T& x) const noexcept(noexcept(x--))
+        -> std::decay_t<decltype(x--)>
+    {
+      return x--;
+    }
+  };
+
+} // ops
+
+namespace impl {
+
+  template <typename Policy, typename Host, typename F>
+  using policy_modify_t = decltype(std::declval<Policy&>().modify(
+      std::declval<Host&>(), std::declval<F>()));
+
+  template <typename Policy, typename Host, typename Op, typename... Args>
+  using policy_compound_t = decltype(std::declval<Policy&>().compound(
+      std::declval<Host&>(), std::declval<Op>(), std::declval<Args>()...));
+
+  /**
+   * The fallback for properties without a hook: apply `f` to `value`, which
+   * is a copy of what the getter returned, and pass the result to `set`.
+   *
+   * Returns whatever `f` returns, by value, because it might refer into the
+   * copy.
+   */
+  template <typename Value, typename F, typename Set>
+  LIBPROPERTY__ACCESSOR constexpr auto modify_copy(
+      Value value, F&& f, Set&& set) -> decltype(auto)
+  {
+    using result_t = std::invoke_result_t<F, Value&>;
+    if constexpr (std::is_void_v<result_t>) {
+      std::invoke(LIBPROPERTY__FORWARD(f), value);
+      LIBPROPERTY__FORWARD(set)(std::move(value));
+    } else {
+      std::decay_t<result_t> result
+          = std::invoke(LIBPROPERTY__FORWARD(f), value);
+      LIBPROPERTY__FORWARD(set)(std::move(value));
+      return result;
+    }
+  }
+
+} // impl
+} // libproperty
+
+/*
+ * The operators, declared in the class body of a property that has a
+ * `compound(op, args...)` member, and a `compound_applies<Op, Args...>`
+ * constant that says whether `compound(Op{}, args...)` would compile.
+ * Operators that would not compile are not declared. Compound assignments and
+ * prefix increments return the property, like the built-in ones return the
+ * object; postfix increments return the old value.
+ */
+#define LIBPROPERTY__DECLARE_COMPOUND_OPERATOR(op, operation)                  \
+  template <typename X,                                                        \
+      typename Op = ::libproperty::ops::operation,                             \
+      std::enable_if_t<compound_applies<Op, X&&>, int> = 0>                    \
+  LIBPROPERTY__ACCESSOR auto& operator op(X&& x)                               \
+  {                                                                            \
+    compound(Op{}, LIBPROPERTY__FORWARD(x));                                   \
+    return *this;                                                              \
+  }                                                                            \
+  static_assert(true, "require semicolon")
+
+#define LIBPROPERTY__DECLARE_COMPOUND_OPERATORS()                              \
+  LIBPROPERTY__DECLARE_COMPOUND_OPERATOR(+=, plus_assign);                     \
+  LIBPROPERTY__DECLARE_COMPOUND_OPERATOR(-=, minus_assign);                    \
+  LIBPROPERTY__DECLARE_COMPOUND_OPERATOR(*=, multiplies_assign);               \
+  LIBPROPERTY__DECLARE_COMPOUND_OPERATOR(/=, divides_assign);                  \
+  LIBPROPERTY__DECLARE_COMPOUND_OPERATOR(%=, modulus_assign);                  \
+  LIBPROPERTY__DECLARE_COMPOUND_OPERATOR(&=, bit_and_assign);                  \
+  LIBPROPERTY__DECLARE_COMPOUND_OPERATOR(|=, bit_or_assign);                   \
+  LIBPROPERTY__DECLARE_COMPOUND_OPERATOR(^=, bit_xor_assign);                  \
+  LIBPROPERTY__DECLARE_COMPOUND_OPERATOR(<<=, shift_left_assign);              \
+  LIBPROPERTY__DECLARE_COMPOUND_OPERATOR(>>=, shift_right_assign);             \
+                                                                               \
+  template <typename Op = ::libproperty::ops::increment,                       \
+      std::enable_if_t<compound_applies<Op>, int> = 0>                         \
+  LIBPROPERTY__ACCESSOR auto& operator++()                                     \
+  {                                                                            \
+    compound(Op{});                                                            \
+    return *this;                                                              \
+  }                                                                            \
+  template <typename Op = ::libproperty::ops::decrement,                       \
+      std::enable_if_t<compound_applies<Op>, int> = 0>                         \
+  LIBPROPERTY__ACCESSOR auto& operator--()                                     \
+  {                                                                            \
+    compound(Op{});                                                            \
+    return *this;                                                              \
+  }                                                                            \
+  template <typename Op = ::libproperty::ops::post_increment,                  \
+      std::enable_if_t<compound_applies<Op>, int> = 0>                         \
+  LIBPROPERTY__ACCESSOR auto operator++(int)                                   \
+  {                                                                            \
+    return compound(Op{});                                                     \
+  }                                                                            \
+  template <typename Op = ::libproperty::ops::post_decrement,                  \
+      std::enable_if_t<compound_applies<Op>, int> = 0>                         \
+  LIBPROPERTY__ACCESSOR auto operator--(int)                                   \
+  {                                                                            \
+    return compound(Op{});                                                     \
+  }                                                                            \
+  static_assert(true, "require semicolon")
+
+#endif
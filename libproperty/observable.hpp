@@ -0,0 +1,357 @@
+#ifndef INCLUDED_LIBPROPERTY_OBSERVABLE_HPP
+#define INCLUDED_LIBPROPERTY_OBSERVABLE_HPP
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015, 2017 Gašper Ažman
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "config.hpp"
+#include "wrapper.hpp"
+
+#include <type_traits>
+#include <utility>
+
+// A wrapped property that tells its observers when it is written.
+#define LIBPROPERTY_OBSERVABLE(type, name, host)                               \
+  LIBPROPERTY_WRAP(                                                            \
+      (::libproperty::observable<LIBPROPERTY__PARENTHESIZED_TYPE type>),       \
+      name,                                                                    \
+      host)
+
+namespace libproperty {
+
+class batch;
+
+namespace impl {
+  /// An observable property in the queue of a batch.
+  struct pending_node {
+    using dispatch_t = void (*)(pending_node&);
+
+    dispatch_t dispatch;
+    pending_node* next_pending = nullptr;
+    batch* queued_in = nullptr;
+
+    explicit pending_node(dispatch_t d) noexcept
+        : dispatch(d)
+    {
+    }
+  };
+} // impl
+
+/**
+ * Defers the notifications of observable properties written on this thread
+ * while it is alive, and then delivers one per property, with its value at
+ * that time, in the order the properties were first written. Batches nest:
+ * the outermost one delivers.
+ *
+ * Observers that write observable properties while the batch delivers are
+ * notified in the same round. Observers must not throw.
+ */
+class batch {
+  impl::pending_node* head_ = nullptr;
+  impl::pending_node** tail_ = &head_;
+  bool outermost_;
+
+  static batch*& current_slot() noexcept
+  {
+    thread_local batch* current = nullptr;
+    return current;
+  }
+
+public:
+  batch() noexcept
+      : outermost_(current_slot() == nullptr)
+  {
+    if (outermost_) {
+      current_slot() = this;
+    }
+  }
+  batch(batch const&) = delete;
+  batch& operator=(batch const&) = delete;
+  ~batch()
+  {
+    if (outermost_) {
+      deliver();
+      current_slot() = nullptr;
+    }
+  }
+
+  /// The batch that notifications on this thread are deferred to, if any.
+  static batch* current() noexcept
+  {
+    return current_slot();
+  }
+
+  /**
+   * Deliver what is pending now, instead of at the end of the batch. On a
+   * nested batch, delivers what the outermost one holds.
+   */
+  void flush()
+  {
+    (outermost_ ? this : current())->deliver();
+  }
+
+private:
+  void deliver()
+  {
+    while (head_ != nullptr) {
+      auto& node = *head_;
+      head_ = node.next_pending;
+      if (head_ == nullptr) {
+        tail_ = &head_;
+      }
+      node.next_pending = nullptr;
+      node.queued_in = nullptr;
+      node.dispatch(node);
+    }
+  }
+
+public:
+
+  void enqueue(impl::pending_node& node) noexcept
+  {
+    if (node.queued_in == nullptr) {
+      node.queued_in = this;
+      *tail_ = &node;
+      tail_ = &node.next_pending;
+    }
+  }
+  void remove(impl::pending_node& node) noexcept
+  {
+    auto** link = &head_;
+    while (*link != &node) {
+      link = &(*link)->next_pending;
+    }
+    *link = node.next_pending;
+    if (tail_ == &node.next_pending) {
+      tail_ = link;
+    }
+    node.next_pending = nullptr;
+    node.queued_in = nullptr;
+  }
+};
+
+template <typename T>
+class observable;
+
+/**
+ * A subscription to an observable property: a node of the property's
+ * intrusive list of observers, so subscribing never allocates. Unsubscribes
+ * itself when destroyed, and is detached if the property goes first.
+ */
+template <typename T>
+class basic_observer {
+  friend class observable<T>;
+  using callback_t = void (*)(basic_observer&, T const&);
+
+  callback_t callback_;
+  observable<T>* source_ = nullptr;
+  basic_observer* prev_ = nullptr;
+  basic_observer* next_ = nullptr;
+
+protected:
+  explicit basic_observer(callback_t callback) noexcept
+      : callback_(callback)
+  {
+  }
+  ~basic_observer()
+  {
+    unsubscribe();
+  }
+
+public:
+  basic_observer(basic_observer const&) = delete;
+  basic_observer& operator=(basic_observer const&) = delete;
+
+  bool subscribed() const noexcept
+  {
+    return source_ != nullptr;
+  }
+  void unsubscribe() noexcept
+  {
+    if (source_ != nullptr) {
+      source_->remove(*this);
+    }
+  }
+};
+
+/// An observer that calls `f(value)`.
+template <typename T, typename F>
+class observer final : public basic_observer<T> {
+  F f_;
+
+  static void call(basic_observer<T>& self, T const& value)
+  {
+    static_cast<observer&>(self).f_(value);
+  }
+
+public:
+  explicit observer(F f)
+      : basic_observer<T>(&call)
+      , f_(std::move(f))
+  {
+  }
+};
+
+template <typename T, typename F>
+observer<T, std::decay_t<F>> make_observer(F&& f)
+{
+  return observer<T, std::decay_t<F>>(LIBPROPERTY__FORWARD(f));
+}
+
+/**
+ * `wrapper` policy that notifies its observers after every write: at once,
+ * or at the end of the current `batch` if there is one. Besides the value, it
+ * stores the head of its observer list and its place in a batch's queue;
+ * observers keep their own links. Not thread-safe.
+ *
+ * Copies of the policy (and so of the host) copy the value, not the
+ * observers.
+ */
+template <typename T>
+class observable : private impl::pending_node {
+  friend class basic_observer<T>;
+
+  T value_;
+  basic_observer<T>* first_ = nullptr;
+
+  static void dispatch(impl::pending_node& node)
+  {
+    static_cast<observable&>(node).notify();
+  }
+
+  void notify()
+  {
+    for (auto* o = first_; o != nullptr;) {
+      // the observer may unsubscribe itself
+      auto* const next = o->next_;
+      o->callback_(*o, value_);
+      o = next;
+    }
+  }
+
+  void remove(basic_observer<T>& o) noexcept
+  {
+    (o.prev_ ? o.prev_->next_ : first_) = o.next_;
+    if (o.next_ != nullptr) {
+      o.next_->prev_ = o.prev_;
+    }
+    o.source_ = nullptr;
+    o.prev_ = o.next_ = nullptr;
+  }
+
+public:
+  using value_type = T;
+
+  template <typename... Args,
+      typename = std::enable_if_t<std::is_constructible_v<T, Args&&...>>>
+  observable(Args&&... args)
+      : impl::pending_node(&dispatch)
+      , value_(LIBPROPERTY__FORWARD(args)...)
+  {
+  }
+  observable(observable const& other)
+      : impl::pending_node(&dispatch)
+      , value_(other.value_)
+  {
+  }
+  observable& operator=(observable const& other)
+  {
+    value_ = other.value_;
+    changed();
+    return *this;
+  }
+  ~observable()
+  {
+    while (first_ != nullptr) {
+      remove(*first_);
+    }
+    if (queued_in != nullptr) {
+      queued_in->remove(*this);
+    }
+  }
+
+  /// Notify the observers, now or at the end of the current batch.
+  void changed()
+  {
+    if (first_ == nullptr) {
+      return;
+    }
+    if (auto* const b = batch::current()) {
+      b->enqueue(*this);
+    } else {
+      notify();
+    }
+  }
+
+  /// Observers added during a notification are notified from the next one.
+  void subscribe(basic_observer<T>& o) noexcept
+  {
+    o.unsubscribe();
+    o.source_ = this;
+    o.next_ = first_;
+    if (first_ != nullptr) {
+      first_->prev_ = &o;
+    }
+    first_ = &o;
+  }
+
+  /* the wrapper protocol */
+  template <typename Host>
+  T const& get(Host const&) const noexcept
+  {
+    return value_;
+  }
+  template <typename Host,
+      typename X,
+      typename = std::enable_if_t<std::is_assignable_v<T&, X&&>>>
+  void set(Host const&, X&& x)
+  {
+    value_ = LIBPROPERTY__FORWARD(x);
+    changed();
+  }
+  /// One notification for the whole modification.
+  template <typename Host, typename F>
+  decltype(auto) modify(Host const&, F&& f)
+  {
+    if constexpr (std::is_void_v<std::invoke_result_t<F&&, T&>>) {
+      LIBPROPERTY__FORWARD(f)(value_);
+      changed();
+    } else {
+      auto result = LIBPROPERTY__FORWARD(f)(value_);
+      changed();
+      return result;
+    }
+  }
+};
+
+/// Calls `o` after every write of `property` until `o` unsubscribes.
+template <typename T, typename Tag>
+void subscribe(wrapper<observable<T>, Tag>& property, basic_observer<T>& o)
+{
+  impl::access::value(property).subscribe(o);
+}
+
+} // libproperty
+
+#endif
@@ -25,6 +25,8 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 */
 
+#include "libproperty/host_access.hpp"
+#include "libproperty/memoized.hpp"
 #include "libproperty/rw_property.hpp"
 #include "libproperty/wrapper.hpp"
 
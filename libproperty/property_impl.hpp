@@ -25,25 +25,55 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 */
 
+#include "config.hpp"
 #include "meta.hpp"
 #include <cstddef> // for std::size_t
+#include <functional>
 #include <new>
 
 #define LIBPROPERTY__PARENTHESIZED_TYPE(...) __VA_ARGS__
 
 #define LIBPROPERTY__TAG_NAME(name) _libproperty__##name##_prop_tag
 
+// The properties of a host, in declaration order: each tag declares an
+// overload of _libproperty__properties that takes a rank one higher than the
+// one before it and returns the previous list with the tag appended.
+#define LIBPROPERTY__PROPERTIES_SO_FAR()                                       \
+  decltype(_libproperty__properties(                                           \
+      ::libproperty::impl::rank<LIBPROPERTY_MAX_PROPERTIES>{}))
+
 #define LIBPROPERTY__DECLARE_TAG(name, host)                                   \
+  static_assert(LIBPROPERTY__PROPERTIES_SO_FAR()::size                         \
+          < LIBPROPERTY_MAX_PROPERTIES,                                        \
+      "too many properties: define LIBPROPERTY_MAX_PROPERTIES higher");        \
   struct LIBPROPERTY__TAG_NAME(name) {                                         \
     using host_type = host;                                                    \
+    LIBPROPERTY__ALLOW_OFFSETOF_BEGIN                                          \
     auto static constexpr offset()                                             \
     {                                                                          \
       return std::integral_constant<size_t, offsetof(host, name)>{};           \
     }                                                                          \
+    LIBPROPERTY__ALLOW_OFFSETOF_END                                            \
+    auto static constexpr member()                                             \
+    {                                                                          \
+      return &host::name;                                                      \
+    }                                                                          \
+    static constexpr char const* property_name() noexcept                      \
+    {                                                                          \
+      return #name;                                                            \
+    }                                                                          \
   };                                                                           \
+  static auto _libproperty__properties(::libproperty::impl::rank<             \
+      LIBPROPERTY__PROPERTIES_SO_FAR()::size + 1>)                             \
+      ->::libproperty::impl::append_t<LIBPROPERTY__PROPERTIES_SO_FAR(),        \
+          LIBPROPERTY__TAG_NAME(name)>;                                        \
   static_assert(true, "need semicolon")
 
 namespace libproperty {
+
+/// What kind of property a `property_traits` specialization describes.
+enum class property_kind { rw_property, wrapper, memoized, bitfield };
+
 /**
  * `property_traits` trait.
  *
@@ -59,6 +89,36 @@ using property_traits_t = property_traits<std::decay_t<Property>>;
 
 namespace impl {
 
+  /// rank<N> converts to rank<M> for all M < N, preferring the largest.
+  template <std::size_t N>
+  struct rank : rank<N - 1> {
+  };
+  template <>
+  struct rank<0> {
+  };
+
+  template <typename... Tags>
+  struct tag_list {
+    static constexpr std::size_t size = sizeof...(Tags);
+  };
+
+  template <typename List, typename Tag>
+  struct append;
+  template <typename... Tags, typename Tag>
+  struct append<tag_list<Tags...>, Tag> {
+    using type = tag_list<Tags..., Tag>;
+  };
+  template <typename List, typename Tag>
+  using append_t = typename append<List, Tag>::type;
+
+  /// Found through ADL by the first property of a host.
+  tag_list<> _libproperty__properties(rank<0>);
+
+  /// The tags of all the properties of `Host`, in declaration order.
+  template <typename Host>
+  using properties_t = decltype(Host::_libproperty__properties(
+      rank<LIBPROPERTY_MAX_PROPERTIES>{}));
+
   template <typename Property>
   using tag_type = typename ::libproperty::property_traits_t<Property>::tag;
 
@@ -87,12 +147,121 @@ namespace impl {
     return ::libproperty::impl::tag_of(property).offset();
   }
 
+  /**
+   * Grants the library, but not users, access to the storage of a property,
+   * whose `value` member is otherwise only accessible to the host.
+   */
+  struct access {
+    template <typename Property>
+    LIBPROPERTY__ACCESSOR static constexpr auto value(
+        Property&& property) noexcept -> decltype(auto)
+    {
+      return (LIBPROPERTY__FORWARD(property).value);
+    }
+    /// The value of a bit-field property, read from its host's word.
+    template <typename Property, typename Host>
+    LIBPROPERTY__ACCESSOR static constexpr auto bits(Host const& host) noexcept
+    {
+      return Property::load(host);
+    }
+    /// Stores `x` in a bit-field property, without counting or marking it.
+    template <typename Property, typename Host, typename X>
+    LIBPROPERTY__ACCESSOR static constexpr void set_bits(
+        Host& host, X const& x) noexcept
+    {
+      Property::store(host, x);
+    }
+    /// The dirty bits of a host with LIBPROPERTY_DIRTY_TRACKING.
+    template <typename Host>
+    LIBPROPERTY__ACCESSOR static constexpr auto dirty(Host const& host) noexcept
+        -> decltype((host._libproperty__dirty))
+    {
+      return (host._libproperty__dirty);
+    }
+  };
+
+  template <typename Host>
+  using dirty_bits_t = std::remove_reference_t<decltype(
+      access::dirty(std::declval<Host const&>()))>;
+
+  template <typename Tag, typename... Tags>
+  constexpr std::size_t index_of() noexcept
+  {
+    constexpr bool found[] = { std::is_same_v<Tag, Tags>..., false };
+    for (std::size_t i = 0; i < sizeof...(Tags); ++i) {
+      if (found[i]) {
+        return i;
+      }
+    }
+    return sizeof...(Tags);
+  }
+
+  /// The declaration index of the property with tag `Tag` in its host.
+  template <typename Tag, typename List = properties_t<typename Tag::host_type>>
+  struct property_index;
+  template <typename Tag, typename... Tags>
+  struct property_index<Tag, tag_list<Tags...>>
+      : std::integral_constant<std::size_t, index_of<Tag, Tags...>()> {
+    static_assert(index_of<Tag, Tags...>() < sizeof...(Tags),
+        "not a registered property of its host");
+  };
+
+  template <typename Tag>
+  using property_of_t = std::remove_reference_t<decltype(
+      std::declval<typename Tag::host_type&>().*Tag::member())>;
+
+  template <typename Property,
+      bool = ::libproperty::property_traits<Property>::kind
+          == ::libproperty::property_kind::bitfield>
+  struct storage_of {
+    using type = std::remove_cv_t<std::remove_reference_t<decltype(
+        access::value(std::declval<Property&>()))>>;
+  };
+  template <typename Property>
+  struct storage_of<Property, true> {
+    using type = typename ::libproperty::property_traits<Property>::value_type;
+  };
+
+  /**
+   * What a property keeps in its `value` member; for bit-fields, which share
+   * their host's word and have no storage of their own, their value type.
+   */
+  template <typename Tag>
+  using storage_t = typename storage_of<property_of_t<Tag>>::type;
+
+  /**
+   * `std::invoke(F, host, args...)`, with the callable as a template argument.
+   *
+   * Getters and setters are compile-time constants, and calling them directly
+   * rather than through `std::invoke` is what lets GCC inline them: it does
+   * not see through a constant member function pointer passed to
+   * `std::invoke`, which leaves a real call in every property access.
+   */
+  template <auto F, typename Host, typename... Args>
+  LIBPROPERTY__ACCESSOR constexpr auto invoke(Host&& host,
+      Args&&... args) noexcept(std::is_nothrow_invocable_v<decltype(F),
+      Host&&,
+      Args&&...>) -> decltype(auto)
+  {
+    using function_t = decltype(F);
+    if constexpr (std::is_member_function_pointer_v<function_t>) {
+      return (LIBPROPERTY__FORWARD(host).*F)(LIBPROPERTY__FORWARD(args)...);
+    } else if constexpr (std::is_member_object_pointer_v<function_t>) {
+      static_assert(sizeof...(Args) == 0, "cannot call a data member");
+      return (LIBPROPERTY__FORWARD(host).*F);
+    } else {
+      return std::invoke(
+          F, std::forward<Host>(host), std::forward<Args>(args)...);
+    }
+  }
+
   /**
    * @param property should be the '*this' pointer of an rw_property or
    * compatible class.
    */
   template <typename Property>
-  constexpr auto get_host(Property&& property) noexcept -> decltype(auto)
+  LIBPROPERTY__ACCESSOR constexpr auto get_host(Property&& property) noexcept
+      -> decltype(auto)
   {
     namespace pm = ::libproperty::meta;
 
@@ -107,12 +276,81 @@ namespace impl {
     // find the offset and apply it. At runtime, all this code amounts to one
     // adjustment of the 'this' pointer by a constant, so most probably one
     // load and one add.
-    auto const property_addr = ::std::addressof(property);
+    auto const property_addr = LIBPROPERTY__ADDRESSOF(property);
     auto const raw_property_ptr = reinterpret_cast<char_ptr_t>(property_addr);
-    auto const offset = offset_of(property);
+    constexpr auto offset = decltype(tag_type<Property>::offset())::value;
     auto const raw_host_ptr = raw_property_ptr - offset;
     auto const host_ptr = reinterpret_cast<host_ptr_t>(raw_host_ptr);
-    return pm::forward_like<Property>(*std::launder(host_ptr));
+    return pm::forward_like<Property>(*LIBPROPERTY__LAUNDER(host_ptr));
+  }
+
+  /**
+   * The memoized properties that writes to a property invalidate, as declared
+   * with LIBPROPERTY_INVALIDATES.
+   */
+  template <auto... Memos>
+  struct dependents {
+    template <typename Host>
+    LIBPROPERTY__ACCESSOR static constexpr void invalidate(
+        Host const& host) noexcept
+    {
+      ((host.*Memos).invalidate(), ...);
+    }
+  };
+
+  template <typename Property, typename Host>
+  using dependents_t = decltype(
+      Host::_libproperty__invalidates(std::declval<Property*>()));
+
+  template <typename Property, typename Host>
+  struct invalidate_on_exit {
+    Host const& host;
+
+    LIBPROPERTY__ACCESSOR ~invalidate_on_exit()
+    {
+      dependents_t<Property, Host>::invalidate(host);
+    }
+  };
+  struct nothing_to_invalidate {
+  };
+
+  /**
+   * Marks `Property` written in its host's dirty bits, if it keeps them.
+   * Called before the setter runs, so a setter that throws or ignores the
+   * value still leaves the bit set.
+   */
+  template <typename Property, typename Host>
+  LIBPROPERTY__ACCESSOR constexpr void mark_dirty(Host const& host) noexcept
+  {
+    namespace pm = ::libproperty::meta;
+    if constexpr (pm::is_detected_v<dirty_bits_t, Host>) {
+      using tag = tag_type<Property>;
+      static_assert(property_index<tag>::value < dirty_bits_t<Host>::size(),
+          "declare LIBPROPERTY_DIRTY_TRACKING after all properties");
+      access::dirty(host).set(property_index<tag>::value);
+    } else {
+      static_cast<void>(host);
+    }
+  }
+
+  /**
+   * Called before every write to `Property`. Marks it dirty, and returns a
+   * guard that invalidates the dependents of `Property` when it goes out of
+   * scope, that is, after the write and whatever it returns. Empty if the
+   * property has no dependents.
+   */
+  template <typename Property, typename Host>
+  LIBPROPERTY__ACCESSOR constexpr auto invalidate_after_write(
+      Host const& host) noexcept
+  {
+    mark_dirty<std::remove_cv_t<Property>>(host);
+    if constexpr (::libproperty::meta::is_detected_v<dependents_t,
+                      std::remove_cv_t<Property>, Host>) {
+      return invalidate_on_exit<std::remove_cv_t<Property>, Host>{ host };
+    } else {
+      static_cast<void>(host);
+      return nothing_to_invalidate{};
+    }
   }
 
 } // impl
@@ -0,0 +1,332 @@
+#ifndef INCLUDED_LIBPROPERTY_RCU_HPP
+#define INCLUDED_LIBPROPERTY_RCU_HPP
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015, 2017 Gašper Ažman
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "config.hpp"
+#include "wrapper.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+// A wrapped property read through immutable snapshots, replaced as a whole.
+#define LIBPROPERTY_RCU(type, name, host)                                      \
+  LIBPROPERTY_WRAP((::libproperty::rcu<LIBPROPERTY__PARENTHESIZED_TYPE type>), \
+      name,                                                                    \
+      host)
+
+namespace libproperty {
+
+namespace impl {
+  /// A number per thread, for spreading threads over shards.
+  inline std::size_t reader_slot() noexcept
+  {
+    static std::atomic<std::size_t> next{ 0 };
+    thread_local std::size_t const slot
+        = next.fetch_add(1, std::memory_order_relaxed);
+    return slot;
+  }
+} // impl
+
+/**
+ * `wrapper` policy for large values that are read very often and replaced
+ * rarely, such as routing tables or configuration maps (read-copy-update).
+ *
+ * The value is immutable and held by a `std::shared_ptr<T const>`. Reading
+ * the property returns that pointer: a snapshot that stays valid and
+ * unchanged for as long as the reader keeps it, whatever writers do.
+ * `libproperty::read(host.prop, f)` calls `f(value)` without even touching
+ * the reference count.
+ *
+ * Writers build a new value, publish it with one atomic pointer swap, and then
+ * wait for the readers that might still be looking at the old pointer to
+ * leave before dropping it; the old value itself lives on until its last
+ * snapshot is gone. Writers serialize on a mutex. `modify(f)` and the compound
+ * operators copy the current value, apply `f`, and publish the copy.
+ *
+ * Readers take no locks: they announce themselves in one of two counters,
+ * whichever the writers currently consider new, and writers flip between the
+ * two to tell old readers from new ones. The counters are sharded by thread,
+ * a cache line per shard, so readers on different cores do not contend; the
+ * pointer and the epoch, which readers only load, have a line of their own.
+ * All of that, about ten cache lines, is allocated once per property, so in
+ * the host the property is a single pointer. Reading the property still
+ * copies a `shared_ptr`, whose reference count all readers share: `read` and
+ * `borrow` do not.
+ */
+template <typename T>
+class rcu {
+public:
+  using value_type = T;
+  using snapshot = std::shared_ptr<T const>;
+
+  /// Shards of the reader counters.
+  static constexpr std::size_t reader_shards = 8;
+
+private:
+  struct alignas(LIBPROPERTY__CACHE_LINE) reader_shard {
+    std::atomic<long> count[2] = {};
+  };
+
+  /// Out of line, so that hosts do not carry it.
+  struct state {
+    alignas(LIBPROPERTY__CACHE_LINE) std::atomic<snapshot*> current;
+    std::atomic<unsigned> epoch{ 0 };
+    reader_shard readers[reader_shards];
+    alignas(LIBPROPERTY__CACHE_LINE) std::mutex writer;
+
+    explicit state(snapshot x)
+        : current(new snapshot(std::move(x)))
+    {
+    }
+    ~state()
+    {
+      delete current.load(std::memory_order_relaxed);
+    }
+  };
+
+  std::unique_ptr<state> const state_;
+
+  /// While alive, the snapshot `current` pointed to at its start stays.
+  class read_section {
+    reader_shard* shard_; // null once moved from
+    unsigned epoch_;
+    snapshot const* current_;
+
+  public:
+    explicit read_section(rcu const& r) noexcept
+        : shard_(&r.state_->readers[impl::reader_slot() % reader_shards])
+    {
+      auto& s = *r.state_;
+      for (;;) {
+        epoch_ = s.epoch.load();
+        shard_->count[epoch_].fetch_add(1);
+        // a writer flipped the epoch under us, and might not wait for us
+        if (s.epoch.load() == epoch_) {
+          break;
+        }
+        shard_->count[epoch_].fetch_sub(1);
+      }
+      // once registered: the writer that replaces this one waits for us
+      current_ = s.current.load();
+    }
+    read_section(read_section&& other) noexcept
+        : shard_(std::exchange(other.shard_, nullptr))
+        , epoch_(other.epoch_)
+        , current_(other.current_)
+    {
+    }
+    read_section& operator=(read_section&&) = delete;
+    ~read_section()
+    {
+      if (shard_ != nullptr) {
+        shard_->count[epoch_].fetch_sub(1, std::memory_order_release);
+      }
+    }
+
+    snapshot const& pinned() const noexcept
+    {
+      return *current_;
+    }
+    T const& value() const noexcept
+    {
+      return **current_;
+    }
+  };
+
+public:
+  /**
+   * The value current when it was borrowed, without a snapshot: writers wait
+   * for it to go away before freeing the value, so keep it briefly, and never
+   * write to the property while holding it. Movable, not copyable.
+   */
+  class borrowed {
+    read_section section_;
+
+  public:
+    explicit borrowed(rcu const& r) noexcept
+        : section_(r)
+    {
+    }
+
+    T const& operator*() const noexcept
+    {
+      return section_.value();
+    }
+    T const* operator->() const noexcept
+    {
+      return LIBPROPERTY__ADDRESSOF(section_.value());
+    }
+  };
+
+private:
+  /// Waits until the readers that started before the call have left.
+  void synchronize() noexcept
+  {
+    unsigned const old = state_->epoch.load(std::memory_order_relaxed);
+    state_->epoch.store(old ^ 1);
+    // seq_cst: the checks must not move before the flip. A reader that
+    // shows up in a shard after it was checked sees the flip, and retries.
+    for (auto& shard : state_->readers) {
+      while (shard.count[old].load() != 0) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  /// Call with the writer lock held.
+  void publish(snapshot next)
+  {
+    auto* const box = new snapshot(std::move(next));
+    std::unique_ptr<snapshot> const old{ state_->current.exchange(box) };
+    synchronize();
+  }
+
+public:
+  rcu()
+      : rcu(T{})
+  {
+  }
+  rcu(T x)
+      : rcu(std::make_shared<T const>(std::move(x)))
+  {
+  }
+  rcu(snapshot x)
+      : state_(std::make_unique<state>(std::move(x)))
+  {
+  }
+  rcu(rcu const& other)
+      : rcu(other.load())
+  {
+  }
+  rcu& operator=(rcu const& other)
+  {
+    if (this != &other) {
+      store(other.load());
+    }
+    return *this;
+  }
+  /// No reader or writer may be active.
+  ~rcu() = default;
+
+  snapshot load() const noexcept
+  {
+    read_section const section{ *this };
+    return section.pinned();
+  }
+  void store(snapshot x)
+  {
+    std::lock_guard<std::mutex> const lock{ state_->writer };
+    publish(std::move(x));
+  }
+  void store(T x)
+  {
+    store(std::make_shared<T const>(std::move(x)));
+  }
+
+  /// `f(value)`; `f` must not write to this property.
+  template <typename F>
+  decltype(auto) read(F&& f) const
+  {
+    read_section const section{ *this };
+    return LIBPROPERTY__FORWARD(f)(section.value());
+  }
+
+  borrowed borrow() const noexcept
+  {
+    return borrowed{ *this };
+  }
+
+  /// Copy, `f(copy)`, publish; returns what `f` returns.
+  template <typename F>
+  decltype(auto) update(F&& f)
+  {
+    std::lock_guard<std::mutex> const lock{ state_->writer };
+    // no other writer can replace the value under us
+    auto next = std::make_shared<T>(**state_->current.load());
+    if constexpr (std::is_void_v<std::invoke_result_t<F&, T&>>) {
+      f(*next);
+      publish(std::move(next));
+    } else {
+      auto result = f(*next);
+      publish(std::move(next));
+      return result;
+    }
+  }
+
+  /* the wrapper protocol */
+  template <typename Host>
+  snapshot get(Host const&) const noexcept
+  {
+    return load();
+  }
+  template <typename Host>
+  void set(Host const&, T x)
+  {
+    store(std::move(x));
+  }
+  template <typename Host>
+  void set(Host const&, snapshot x)
+  {
+    store(std::move(x));
+  }
+  /// `U u = host.prop` copies (or converts) the value out.
+  template <typename U,
+      typename Host,
+      typename = std::enable_if_t<std::is_constructible_v<U, T const&>>>
+  U convert_to(Host const&) const
+  {
+    return read([](T const& x) { return static_cast<U>(x); });
+  }
+  /// `f` runs under the writer lock, on a copy.
+  template <typename Host, typename F>
+  decltype(auto) modify(Host const&, F&& f)
+  {
+    return update(LIBPROPERTY__FORWARD(f));
+  }
+};
+
+/// `f(value)` under a read section, without taking a snapshot.
+template <typename T, typename Tag, typename F>
+decltype(auto) read(wrapper<rcu<T>, Tag> const& property, F&& f)
+{
+  return impl::access::value(property).read(LIBPROPERTY__FORWARD(f));
+}
+
+/// The current value of `property`, without touching the reference count.
+template <typename T, typename Tag>
+typename rcu<T>::borrowed borrow(wrapper<rcu<T>, Tag> const& property) noexcept
+{
+  return impl::access::value(property).borrow();
+}
+
+} // libproperty
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef INCLUDED_LIBPROPERTY_REFLECTION_HPP
+#define INCLUDED_LIBPROPERTY_REFLECTION_HPP
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015, 2017 Gašper Ažman
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/*
+ * Compile-time enumeration of the properties of a host: every property macro
+ * registers its tag in a list on the host, in declaration order.
+ */
+
+#include "property_impl.hpp"
+
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace libproperty {
+
+/// Everything known about one property at compile time.
+template <typename Tag>
+struct property_info {
+  using tag = Tag;
+  using host_type = typename Tag::host_type;
+  using property_type = std::remove_reference_t<decltype(
+      std::declval<host_type&>().*Tag::member())>;
+  using traits = property_traits<property_type>;
+  /// `T` for `rw_property`, `memoized` and `bitfield`, the policy for
+  /// `wrapper`.
+  using value_type = typename traits::value_type;
+  /// What the property stores; the value type, for bitfields.
+  using storage_type = impl::storage_t<Tag>;
+
+  static constexpr std::string_view name = Tag::property_name();
+  static constexpr std::size_t offset = decltype(Tag::offset())::value;
+  static constexpr property_kind kind = traits::kind;
+  static constexpr auto member = Tag::member();
+};
+
+namespace impl {
+  template <typename List>
+  struct property_infos;
+  template <typename... Tags>
+  struct property_infos<tag_list<Tags...>> {
+    template <typename F>
+    LIBPROPERTY__ACCESSOR static constexpr void visit(F&& f)
+    {
+      (f(property_info<Tags>{}), ...);
+    }
+    template <typename Host, typename F>
+    LIBPROPERTY__ACCESSOR static constexpr void visit(Host&& host, F&& f)
+    {
+      (f(LIBPROPERTY__FORWARD(host).*Tags::member(), property_info<Tags>{}),
+          ...);
+    }
+  };
+} // impl
+
+/// The number of properties of `Host`.
+template <typename Host>
+constexpr std::size_t property_count
+    = impl::properties_t<std::decay_t<Host>>::size;
+
+/**
+ * Calls `f(info)` with a `property_info` for each property of `Host`, in
+ * declaration order.
+ */
+template <typename Host, typename F>
+LIBPROPERTY__ACCESSOR constexpr void for_each_property(F&& f)
+{
+  impl::property_infos<impl::properties_t<Host>>::visit(
+      LIBPROPERTY__FORWARD(f));
+}
+
+/**
+ * Calls `f(property, info)` for each property of `host`, in declaration
+ * order, with the property as cv- and value-category-qualified as `host`.
+ * Unrolls into one call per property.
+ */
+template <typename Host, typename F>
+LIBPROPERTY__ACCESSOR constexpr void for_each_property(Host&& host, F&& f)
+{
+  impl::property_infos<impl::properties_t<std::decay_t<Host>>>::visit(
+      LIBPROPERTY__FORWARD(host), LIBPROPERTY__FORWARD(f));
+}
+
+} // libproperty
+
+#endif
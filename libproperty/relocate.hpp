@@ -0,0 +1,120 @@
+#ifndef INCLUDED_LIBPROPERTY_RELOCATE_HPP
+#define INCLUDED_LIBPROPERTY_RELOCATE_HPP
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015, 2017 Gašper Ažman
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/*
+ * Relocation: moving an object to a new address and ending its life at the
+ * old one, which for most types is the same as copying its bytes.
+ *
+ * Properties keep nothing that depends on their own address (they find their
+ * host by a constant offset), and their special members are defaulted, so a
+ * host is trivially copyable, destructible and relocatable whenever the
+ * values it stores are. tests/relocate.cpp pins that down.
+ */
+
+#include "property_impl.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace libproperty {
+
+/**
+ * Whether a `T` can be relocated by copying its bytes and not running its
+ * destructor. True for trivially copyable types; specialize it for types that
+ * are relocatable but not trivially copyable, e.g. a host that owns a
+ * `std::unique_ptr`.
+ */
+template <typename T>
+struct is_trivially_relocatable
+    : std::bool_constant<std::is_trivially_copyable_v<T>> {
+};
+template <typename T>
+constexpr bool is_trivially_relocatable_v
+    = is_trivially_relocatable<std::remove_cv_t<T>>::value;
+
+namespace impl {
+  template <typename Host, typename... Tags>
+  constexpr bool all_storage_relocatable(tag_list<Tags...>) noexcept
+  {
+    return (is_trivially_relocatable_v<storage_t<Tags>> && ...);
+  }
+} // impl
+
+/**
+ * Whether everything the properties of `Host` store is trivially
+ * relocatable. A host that also has no other members that aren't can
+ * specialize `is_trivially_relocatable` on this.
+ */
+template <typename Host>
+constexpr bool properties_trivially_relocatable_v
+    = impl::all_storage_relocatable<Host>(impl::properties_t<Host>{});
+
+/**
+ * Relocate `n` objects from `first` to the uninitialized storage at `result`:
+ * afterwards the objects live at `result` and the storage at `first` is
+ * uninitialized. Returns `result + n`.
+ *
+ * Trivially relocatable objects are moved with one `memmove`, and the ranges
+ * may overlap. Others are move-constructed and destroyed one by one, and the
+ * ranges may only overlap if `result` is before `first`. If a move constructor
+ * throws, the objects before it have been relocated and the rest have not.
+ */
+template <typename T>
+T* relocate_n(T* first, std::size_t n, T* result) noexcept(
+    is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>)
+{
+  if constexpr (is_trivially_relocatable_v<T>) {
+    if (n != 0) {
+      std::memmove(static_cast<void*>(result),
+          static_cast<void const*>(first),
+          n * sizeof(T));
+    }
+    return LIBPROPERTY__LAUNDER(result) + n;
+  } else {
+    for (std::size_t i = 0; i < n; ++i) {
+      ::new (static_cast<void*>(result + i)) T(std::move(first[i]));
+      first[i].~T();
+    }
+    return result + n;
+  }
+}
+
+/// Relocate the one object at `source` to `result`; see relocate_n.
+template <typename T>
+T* relocate_at(T* source, T* result) noexcept(noexcept(relocate_n(
+    source, 1, result)))
+{
+  relocate_n(source, 1, result);
+  return LIBPROPERTY__LAUNDER(result);
+}
+
+} // libproperty
+
+#endif
@@ -25,42 +25,111 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 */
 
+#include "instrument.hpp"
+#include "modify.hpp"
 #include "property_impl.hpp"
 
 #include <type_traits>
 #include <utility> // for std::forward
 #include <functional>
 
-#define LIBPROPERTY_PROPERTY2(type, name, getter, setter, host)                \
+// `meta` is a parenthesized rw_property_meta.
+#define LIBPROPERTY__RW_PROPERTY(attrs, type, name, meta, host)                \
   LIBPROPERTY__DECLARE_TAG(name, host);                                        \
-  ::libproperty::rw_property<LIBPROPERTY__PARENTHESIZED_TYPE type,             \
-      host::LIBPROPERTY__TAG_NAME(name)>                                       \
+  attrs ::libproperty::rw_property<type, host::LIBPROPERTY__TAG_NAME(name)>    \
       name;                                                                    \
   auto static constexpr _libproperty__rw_property_props(decltype(name)*)       \
   {                                                                            \
-    return ::libproperty::rw_property_meta<getter, setter>{};                  \
+    return LIBPROPERTY__PARENTHESIZED_TYPE meta{};                             \
   }                                                                            \
   static_assert("require semicolon")
 
+#define LIBPROPERTY_PROPERTY2(type, name, getter, setter, host)                \
+  LIBPROPERTY__RW_PROPERTY(, LIBPROPERTY__PARENTHESIZED_TYPE type, name,       \
+      (::libproperty::rw_property_meta<getter, setter>), host)
+
 // only call in class scope!
 #define LIBPROPERTY_PROPERTY(type, name, getter, setter, host)                 \
   LIBPROPERTY_PROPERTY2(type, name, &host::getter, &host::setter, host)
 
+// A property with a getter of its own for rvalue hosts, so that
+// `std::move(host).name` can move the value out instead of copying it.
+#define LIBPROPERTY_MOVABLE_PROPERTY2(                                         \
+    type, name, getter, move_getter, setter, host)                             \
+  LIBPROPERTY__RW_PROPERTY(, LIBPROPERTY__PARENTHESIZED_TYPE type, name,       \
+      (::libproperty::rw_property_meta<getter, setter, move_getter>), host)
+
+#define LIBPROPERTY_MOVABLE_PROPERTY(                                          \
+    type, name, getter, move_getter, setter, host)                             \
+  LIBPROPERTY_MOVABLE_PROPERTY2(                                               \
+      type, name, &host::getter, &host::move_getter, &host::setter, host)
+
 // end define
+// A property without a value, which takes no room in the host if
+// LIBPROPERTY__EMPTY_TAKES_NO_SPACE, and a char otherwise.
 #define LIBPROPERTY_EMPTY_PROPERTY(name, getter, setter, host)                 \
-  LIBPROPERTY_PROPERTY((char), name, getter, setter, host)
+  LIBPROPERTY_EMPTY_PROPERTY2(name, &host::getter, &host::setter, host)
 
 #define LIBPROPERTY_EMPTY_PROPERTY2(name, getter, setter, host)                \
-  LIBPROPERTY_PROPERTY2((char), name, getter, setter, host)
+  LIBPROPERTY__RW_PROPERTY(LIBPROPERTY__NO_UNIQUE_ADDRESS,                     \
+      ::libproperty::impl::empty_value<host::LIBPROPERTY__TAG_NAME(name)>,     \
+      name, (::libproperty::rw_property_meta<getter, setter>), host)
+
+// Optional: `host.modifier(f)` applies `f` to the value of `name` in place and
+// returns what `f` returns. Used by `modify` and the compound operators instead
+// of the getter and setter. Only call in class scope, after `name`.
+#define LIBPROPERTY_MODIFIER(name, modifier, host)                             \
+  template <typename F>                                                        \
+  auto static constexpr _libproperty__rw_property_modify(                      \
+      decltype(name)*, host& h, F&& f)                                         \
+      ->decltype(auto)                                                         \
+  {                                                                            \
+    return h.modifier(static_cast<F&&>(f));                                    \
+  }                                                                            \
+  static_assert(true, "require semicolon")
 
 namespace libproperty {
 
-template <auto Getter, auto Setter>
+/**
+ * The accessors of an rw_property: `getter` reads it from a const host,
+ * `move_getter` from an rvalue one (the getter, unless given), and `setter`
+ * writes it.
+ */
+template <auto Getter, auto Setter, auto MoveGetter = Getter>
 struct rw_property_meta {
   static constexpr auto getter = Getter;
   static constexpr auto setter = Setter;
+  static constexpr auto move_getter = MoveGetter;
 };
 
+namespace impl {
+#if LIBPROPERTY__EMPTY_TAKES_NO_SPACE
+  /// One type per property, so that empty properties can share an address.
+  template <typename Tag>
+  struct empty_value {
+  };
+#else
+  template <typename Tag>
+  using empty_value = char;
+#endif
+
+  template <typename Property, typename Host, typename F>
+  using rw_modify_hook_t = decltype(Host::_libproperty__rw_property_modify(
+      std::declval<Property*>(), std::declval<Host&>(), std::declval<F>()));
+
+  template <typename Property>
+  using getter_t = decltype(meta_type<Property>::getter);
+  template <typename Property>
+  using move_getter_t = decltype(meta_type<Property>::move_getter);
+  template <typename Property>
+  using setter_t = decltype(meta_type<Property>::setter);
+
+  /// What reading the property gives, as a value.
+  template <typename Property>
+  using rw_value_t = std::decay_t<
+      std::invoke_result_t<getter_t<Property>, host_type<Property> const&>>;
+} // impl
+
 template <typename T, typename Tag>
 class rw_property {
   using host = typename Tag::host_type;
@@ -68,8 +137,9 @@ class rw_property {
 
   // allow `host` to access self::value
   friend host;
+  friend struct ::libproperty::impl::access;
 
-  value_type value; // possibly unused.
+  LIBPROPERTY__NO_UNIQUE_ADDRESS value_type value; // possibly unused.
 
   /// disallow copying for non-friend users of the class - this doesn't have a
   /// value, but if copied, it can get really, really bad (stack corruption).
@@ -90,28 +160,106 @@ class rw_property {
       : value(x)
   {
   }
+  // in-place construction, for values that can't be moved
+  template <typename... Args>
+  constexpr rw_property(std::in_place_t, Args&&... args) noexcept(
+      std::is_nothrow_constructible_v<T, Args&&...>)
+      : value(std::forward<Args>(args)...)
+  {
+  }
+
+  /// Whether `compound(Op{}, args...)` compiles; see modify.hpp.
+  template <typename Op, typename... Args>
+  static constexpr bool compound_applies = std::is_invocable_v<Op,
+      ::libproperty::impl::rw_value_t<rw_property>&,
+      Args...>;
 
 public:
-  constexpr operator decltype(auto)() const
+  LIBPROPERTY__ACCESSOR constexpr operator decltype(auto)() const & noexcept(
+      std::is_nothrow_invocable_v<::libproperty::impl::getter_t<rw_property>,
+          host const&>)
+  {
+    namespace pi = ::libproperty::impl;
+    [[maybe_unused]] pi::probe<Tag, pi::access_kind::read> const probe{};
+    return pi::invoke<pi::meta_type<rw_property>::getter>(pi::get_host(*this));
+  }
+  /// The host is expiring: read through the move getter.
+  LIBPROPERTY__ACCESSOR constexpr operator decltype(auto)() && noexcept(
+      std::is_nothrow_invocable_v<
+          ::libproperty::impl::move_getter_t<rw_property>,
+          host&&>)
+  {
+    namespace pi = ::libproperty::impl;
+    [[maybe_unused]] pi::probe<Tag, pi::access_kind::read> const probe{};
+    return pi::invoke<pi::meta_type<rw_property>::move_getter>(
+        pi::get_host(static_cast<rw_property&&>(*this)));
+  }
+
+  // decltype(auto): I don't want to say it 3 times...
+  template <typename X,
+      typename P = rw_property,
+      std::enable_if_t<std::is_invocable_v<::libproperty::impl::setter_t<P>,
+                           host&,
+                           X&&>,
+          int> = 0>
+  LIBPROPERTY__ACCESSOR decltype(auto) operator=(X&& x) noexcept(
+      std::is_nothrow_invocable_v<::libproperty::impl::setter_t<P>, host&, X&&>)
   {
     namespace pi = ::libproperty::impl;
-    return std::invoke(pi::meta(*this).getter, pi::get_host(*this));
+    [[maybe_unused]] pi::probe<Tag, pi::access_kind::write> const probe{};
+    auto& h = pi::get_host(*this);
+    [[maybe_unused]] auto const written
+        = pi::invalidate_after_write<rw_property>(h);
+    return pi::invoke<pi::meta_type<rw_property>::setter>(
+        h, LIBPROPERTY__FORWARD(x));
   }
 
-  template <typename X>
-  decltype(auto) operator=(X&& x) // I don't want to say it 3 times...
+  /**
+   * Apply `f` to the value in place, through the host's LIBPROPERTY_MODIFIER
+   * hook if it has one, or else to a copy obtained from the getter, which is
+   * then passed to the setter. Returns what `f` returns.
+   */
+  template <typename F>
+  LIBPROPERTY__ACCESSOR decltype(auto) modify(F&& f)
   {
     namespace pi = ::libproperty::impl;
-    return std::invoke(
-        pi::meta(*this).setter, pi::get_host(*this), std::forward<X>(x));
+    namespace pm = ::libproperty::meta;
+    using meta = pi::meta_type<rw_property>;
+
+    [[maybe_unused]] pi::probe<Tag, pi::access_kind::write> const probe{};
+    auto& h = pi::get_host(*this);
+    [[maybe_unused]] auto const written
+        = pi::invalidate_after_write<rw_property>(h);
+    if constexpr (pm::is_detected_v<pi::rw_modify_hook_t, rw_property, host,
+                      F&&>) {
+      return host::_libproperty__rw_property_modify(
+          this, h, LIBPROPERTY__FORWARD(f));
+    } else {
+      return pi::modify_copy(pi::invoke<meta::getter>(std::as_const(h)),
+          LIBPROPERTY__FORWARD(f),
+          [&h](auto&& v) { pi::invoke<meta::setter>(h, std::move(v)); });
+    }
   }
+
+  /// Apply `op(value, args...)` in place; see `modify`.
+  template <typename Op, typename... Args>
+  LIBPROPERTY__ACCESSOR decltype(auto) compound(Op op, Args&&... args)
+  {
+    return modify([&](auto& v) -> decltype(auto) {
+      return op(v, LIBPROPERTY__FORWARD(args)...);
+    });
+  }
+
+  LIBPROPERTY__DECLARE_COMPOUND_OPERATORS();
 };
 
 template <typename T, typename Tag>
 struct property_traits<rw_property<T, Tag>> {
   using property = rw_property<T, Tag>;
   static constexpr std::true_type is_property = {};
+  static constexpr property_kind kind = property_kind::rw_property;
   using tag = Tag;
+  using value_type = T;
   using host = typename tag::host_type;
   using meta = decltype(
       host::_libproperty__rw_property_props(std::declval<property*>()));
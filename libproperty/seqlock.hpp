@@ -0,0 +1,205 @@
+#ifndef INCLUDED_LIBPROPERTY_SEQLOCK_HPP
+#define INCLUDED_LIBPROPERTY_SEQLOCK_HPP
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015, 2017 Gašper Ažman
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "config.hpp"
+#include "wrapper.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// A wrapped property stored under a sequence lock.
+#define LIBPROPERTY_SEQLOCK(type, name, host)                                  \
+  LIBPROPERTY_WRAP(                                                            \
+      (::libproperty::seqlock<LIBPROPERTY__PARENTHESIZED_TYPE type>),          \
+      name,                                                                    \
+      host)
+
+namespace libproperty {
+
+/**
+ * `wrapper` policy for values too wide for lock-free atomics, read by many
+ * threads and written by few.
+ *
+ * The value is stored next to a sequence counter, which is odd while a write
+ * is in progress. Readers never write to the policy: they copy the value out
+ * and retry if the counter was odd or changed in the meantime. Writers
+ * serialize on the counter, so there may be more than one, but a reader can
+ * starve under a constant stream of writes.
+ *
+ * The value is kept in relaxed atomic words rather than as a `T`, so that
+ * copying it out while it is being written is not a data race; on common
+ * hardware these are plain loads and stores.
+ *
+ * `modify(f)` and the compound operators run under the writer lock, so
+ * concurrent read-modify-writes do not lose updates.
+ */
+template <typename T>
+class seqlock {
+  static_assert(std::is_trivially_copyable_v<T>,
+      "seqlock values are copied word by word");
+  static_assert(std::is_default_constructible_v<T>,
+      "seqlock readers need somewhere to copy the value to");
+
+  using word = std::uintptr_t;
+  static constexpr std::size_t words = (sizeof(T) + sizeof(word) - 1)
+      / sizeof(word);
+  static_assert(alignof(T) <= alignof(std::atomic<word>),
+      "over-aligned values are not supported");
+
+  std::atomic<unsigned> sequence_{ 0 };
+  std::atomic<word> value_[words];
+
+  void copy_in(T const& x) noexcept
+  {
+    word buffer[words] = {};
+    std::memcpy(buffer, &x, sizeof(T));
+    for (std::size_t i = 0; i < words; ++i) {
+      value_[i].store(buffer[i], std::memory_order_relaxed);
+    }
+  }
+  T copy_out() const noexcept
+  {
+    word buffer[words];
+    for (std::size_t i = 0; i < words; ++i) {
+      buffer[i] = value_[i].load(std::memory_order_relaxed);
+    }
+    T x;
+    std::memcpy(&x, buffer, sizeof(T));
+    return x;
+  }
+
+  /// Serializes writers; the counter is odd while one holds it.
+  class writer {
+    seqlock& lock_;
+    unsigned sequence_;
+
+  public:
+    explicit writer(seqlock& lock) noexcept
+        : lock_(lock)
+        , sequence_(lock.sequence_.load(std::memory_order_relaxed))
+    {
+      for (;;) {
+        // acquire: see everything the previous writer wrote
+        if (sequence_ % 2 == 0
+            && lock_.sequence_.compare_exchange_weak(sequence_,
+                   sequence_ + 1,
+                   std::memory_order_acquire,
+                   std::memory_order_relaxed)) {
+          // the value writes can't move before the counter write
+          std::atomic_thread_fence(std::memory_order_release);
+          return;
+        }
+        LIBPROPERTY__CPU_RELAX();
+        sequence_ = lock_.sequence_.load(std::memory_order_relaxed);
+      }
+    }
+    writer(writer const&) = delete;
+    writer& operator=(writer const&) = delete;
+    ~writer()
+    {
+      lock_.sequence_.store(sequence_ + 2, std::memory_order_release);
+    }
+  };
+
+public:
+  using value_type = T;
+
+  seqlock() noexcept
+  {
+    copy_in(T{});
+  }
+  seqlock(T const& x) noexcept
+  {
+    copy_in(x);
+  }
+  seqlock(seqlock const& other) noexcept
+  {
+    copy_in(other.load());
+  }
+  seqlock& operator=(seqlock const& other) noexcept
+  {
+    store(other.load());
+    return *this;
+  }
+
+  /// a consistent snapshot of the value
+  T load() const noexcept
+  {
+    for (;;) {
+      unsigned const before = sequence_.load(std::memory_order_acquire);
+      if (before % 2 == 0) {
+        T const x = copy_out();
+        // the value reads can't move after the second counter read
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence_.load(std::memory_order_relaxed) == before) {
+          return x;
+        }
+      }
+      LIBPROPERTY__CPU_RELAX();
+    }
+  }
+  void store(T const& x) noexcept
+  {
+    writer const w{ *this };
+    copy_in(x);
+  }
+
+  /* the wrapper protocol */
+  template <typename Host>
+  T get(Host const&) const noexcept
+  {
+    return load();
+  }
+  template <typename Host>
+  void set(Host const&, T const& x) noexcept
+  {
+    store(x);
+  }
+  /// `f` runs under the writer lock, and must not access the property.
+  template <typename Host, typename F>
+  decltype(auto) modify(Host const&, F&& f)
+  {
+    writer const w{ *this };
+    // no other writer can change the value under us: no retries
+    T x = copy_out();
+    if constexpr (std::is_void_v<std::invoke_result_t<F&, T&>>) {
+      f(x);
+      copy_in(x);
+    } else {
+      auto result = f(x);
+      copy_in(x);
+      return result;
+    }
+  }
+};
+
+} // libproperty
+
+#endif
@@ -0,0 +1,431 @@
+#ifndef INCLUDED_LIBPROPERTY_SNAPSHOT_HPP
+#define INCLUDED_LIBPROPERTY_SNAPSHOT_HPP
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015, 2017 Gašper Ažman
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/*
+ * Binary snapshots of arrays of hosts.
+ *
+ * A snapshot is a header, the schema of the host (the name, offset, size,
+ * kind and type of every property, from reflection.hpp), and the hosts.
+ * Trivially copyable hosts are stored as they are in memory, and a snapshot of
+ * them can be used in place. Other hosts are stored property by property:
+ * values of trivially copyable types as their bytes, others through the
+ * property's getter and setter and `snapshot_traits`. Those hosts keep only
+ * their properties: any other data member is not written, and is left as it
+ * was in the hosts a snapshot is restored into.
+ *
+ * Snapshots are meant to be read back by the same build on the same platform;
+ * reading one checks that the schema matches and throws `snapshot_error` if
+ * it does not.
+ */
+
+#include "reflection.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace libproperty {
+
+struct snapshot_error : std::runtime_error {
+  using std::runtime_error::runtime_error;
+};
+
+/**
+ * How to write a value that is not trivially copyable into a snapshot.
+ * Specialize for your own types; `write(value, put)` calls
+ * `put(void const*, std::size_t)` for its bytes, and `read(get)` calls
+ * `get(void*, std::size_t)` to get them back. `get.remaining()` is the number
+ * of bytes left in the snapshot, to check untrusted sizes against before
+ * allocating.
+ */
+template <typename T, typename = void>
+struct snapshot_traits {
+  static_assert(std::is_trivially_copyable_v<T>,
+      "specialize libproperty::snapshot_traits for this type");
+
+  template <typename Put>
+  static void write(T const& value, Put&& put)
+  {
+    put(LIBPROPERTY__ADDRESSOF(value), sizeof(T));
+  }
+  template <typename Get>
+  static T read(Get&& get)
+  {
+    T value;
+    get(LIBPROPERTY__ADDRESSOF(value), sizeof(T));
+    return value;
+  }
+};
+
+namespace impl {
+  enum class snapshot_category : std::uint32_t {
+    boolean = 1,
+    integral,
+    floating,
+    enumeration,
+    pointer,
+    other,
+  };
+
+  template <typename T>
+  constexpr snapshot_category snapshot_category_of()
+  {
+    if constexpr (std::is_same_v<T, bool>) {
+      return snapshot_category::boolean;
+    } else if constexpr (std::is_integral_v<T>) {
+      return snapshot_category::integral;
+    } else if constexpr (std::is_floating_point_v<T>) {
+      return snapshot_category::floating;
+    } else if constexpr (std::is_enum_v<T>) {
+      return snapshot_category::enumeration;
+    } else if constexpr (std::is_pointer_v<T>) {
+      return snapshot_category::pointer;
+    } else {
+      return snapshot_category::other;
+    }
+  }
+} // impl
+
+/**
+ * The type of a property in the schema of a snapshot, so that a `long` is not
+ * read back as a `double` of the same name and size. By default: whether it is
+ * a bool, an integer, a floating-point number, an enum, a pointer or something
+ * else, whether it is signed, and its alignment. Specialize for your own types
+ * to tell apart ones these do not.
+ */
+template <typename T, typename = void>
+struct snapshot_type_id {
+  static constexpr std::uint32_t value
+      = static_cast<std::uint32_t>(impl::snapshot_category_of<T>())
+      | std::uint32_t{ std::is_signed_v<T> } << 4
+      | static_cast<std::uint32_t>(alignof(T)) << 8;
+};
+
+namespace impl {
+  /// Whether `Container` keeps its elements in one array, at `data()`.
+  template <typename Container>
+  using contiguous_data_t = std::enable_if_t<
+      std::is_same_v<decltype(std::declval<Container const&>().data()),
+          typename Container::value_type const*>>;
+} // impl
+
+/**
+ * Strings and vectors, and other containers whose `data()` holds all their
+ * elements, of trivially copyable elements: a length, then those.
+ */
+template <typename Container>
+struct snapshot_traits<Container,
+    std::enable_if_t<!std::is_trivially_copyable_v<Container>
+        && std::is_trivially_copyable_v<typename Container::value_type>
+        && meta::is_detected_v<impl::contiguous_data_t, Container>>> {
+  template <typename Put>
+  static void write(Container const& value, Put&& put)
+  {
+    std::uint64_t const size = value.size();
+    put(&size, sizeof(size));
+    put(value.data(), size * sizeof(typename Container::value_type));
+  }
+  template <typename Get>
+  static Container read(Get&& get)
+  {
+    std::uint64_t size;
+    get(&size, sizeof(size));
+    // divide rather than multiply: the size is untrusted and may overflow
+    if (size > get.remaining() / sizeof(typename Container::value_type)) {
+      throw snapshot_error("libproperty snapshot: truncated data");
+    }
+    Container value(size, typename Container::value_type{});
+    get(value.data(), size * sizeof(typename Container::value_type));
+    return value;
+  }
+};
+
+namespace impl {
+  struct snapshot_header {
+    char magic[8];
+    std::uint32_t host_size;
+    std::uint32_t host_align;
+    std::uint32_t properties;
+    std::uint32_t in_place; // the hosts are stored as they are in memory
+    std::uint64_t count;
+    std::uint64_t data_offset; // from the start of the snapshot
+  };
+  constexpr char snapshot_magic[8] = { 'L', 'I', 'B', 'P', 'S', 'N', 'P', '2' };
+
+  struct snapshot_property {
+    std::uint32_t offset;
+    std::uint32_t size;
+    std::uint32_t kind;
+    std::uint32_t type; // snapshot_type_id of what is written
+    std::uint32_t name_size; // followed by the name
+  };
+
+  /// Reads the bytes of a snapshot between `in` and `end`, in order.
+  struct snapshot_reader {
+    char const* in;
+    char const* end;
+
+    std::size_t remaining() const noexcept
+    {
+      return static_cast<std::size_t>(end - in);
+    }
+    void operator()(void* p, std::size_t n)
+    {
+      if (remaining() < n) {
+        throw snapshot_error("libproperty snapshot: truncated data");
+      }
+      std::memcpy(p, in, n);
+      in += n;
+    }
+  };
+
+  /// The data starts at a multiple of this from the start of the snapshot.
+  constexpr std::size_t snapshot_align = alignof(std::max_align_t);
+
+  template <typename Host>
+  constexpr bool snapshot_in_place
+      = std::is_trivially_copyable_v<Host> && std::is_standard_layout_v<Host>;
+
+  /// What the getter of the property returns, and its setter takes: the
+  /// `value_type` of the policy, for wrappers.
+  template <typename Info, bool = Info::kind == property_kind::wrapper>
+  struct snapshot_value {
+    using type = typename Info::value_type;
+  };
+  template <typename Info>
+  struct snapshot_value<Info, true> {
+    using type = typename Info::value_type::value_type;
+  };
+  template <typename Info>
+  using snapshot_value_t = typename snapshot_value<Info>::type;
+
+  template <typename Info>
+  constexpr bool snapshot_as_bytes
+      = std::is_trivially_copyable_v<typename Info::storage_type>
+      && Info::kind != property_kind::bitfield;
+
+  /// The type whose bytes, or whose `snapshot_traits`, a property is written
+  /// with.
+  template <typename Info>
+  using snapshot_written_t = std::conditional_t<snapshot_as_bytes<Info>,
+      typename Info::storage_type,
+      std::conditional_t<Info::kind == property_kind::bitfield,
+          typename Info::value_type, snapshot_value_t<Info>>>;
+
+  /// The header and schema of a snapshot of `count` `Host`s.
+  template <typename Host>
+  std::vector<char> snapshot_prefix(std::uint64_t count)
+  {
+    std::vector<char> prefix(sizeof(snapshot_header));
+    auto const put = [&prefix](void const* p, std::size_t n) {
+      auto const bytes = static_cast<char const*>(p);
+      prefix.insert(prefix.end(), bytes, bytes + n);
+    };
+    for_each_property<Host>([&](auto info) {
+      using info_t = decltype(info);
+      snapshot_property const property{
+        static_cast<std::uint32_t>(info_t::offset),
+        static_cast<std::uint32_t>(sizeof(typename info_t::storage_type)),
+        static_cast<std::uint32_t>(info_t::kind),
+        snapshot_type_id<snapshot_written_t<info_t>>::value,
+        static_cast<std::uint32_t>(info_t::name.size()),
+      };
+      put(&property, sizeof(property));
+      put(info_t::name.data(), info_t::name.size());
+    });
+    prefix.resize(
+        (prefix.size() + snapshot_align - 1) / snapshot_align * snapshot_align);
+
+    snapshot_header header{};
+    std::memcpy(header.magic, snapshot_magic, sizeof(header.magic));
+    header.host_size = sizeof(Host);
+    header.host_align = alignof(Host);
+    header.properties = property_count<Host>;
+    header.in_place = snapshot_in_place<Host>;
+    header.count = count;
+    header.data_offset = prefix.size();
+    std::memcpy(prefix.data(), &header, sizeof(header));
+    return prefix;
+  }
+
+  /// Writes the hosts that are not stored in place, property by property.
+  template <typename Host, typename Put>
+  void write_properties(Host const& host, Put&& put)
+  {
+    for_each_property(host, [&](auto const& property, auto info) {
+      using info_t = decltype(info);
+      if constexpr (snapshot_as_bytes<info_t>) {
+        auto const& storage = access::value(property);
+        put(LIBPROPERTY__ADDRESSOF(storage), sizeof(storage));
+      } else if constexpr (info_t::kind == property_kind::bitfield) {
+        auto const value = access::bits<typename info_t::property_type>(host);
+        put(LIBPROPERTY__ADDRESSOF(value), sizeof(value));
+      } else if constexpr (info_t::kind != property_kind::memoized) {
+        using value_t = snapshot_value_t<info_t>;
+        value_t const& value = property;
+        snapshot_traits<value_t>::write(value, put);
+      } // memoized properties are recomputed after a restore
+    });
+  }
+
+  template <typename Host, typename Get>
+  void read_properties(Host& host, Get&& get)
+  {
+    for_each_property(host, [&](auto& property, auto info) {
+      using info_t = decltype(info);
+      if constexpr (snapshot_as_bytes<info_t>) {
+        auto& storage = access::value(property);
+        get(LIBPROPERTY__ADDRESSOF(storage), sizeof(storage));
+      } else if constexpr (info_t::kind == property_kind::bitfield) {
+        typename info_t::value_type value;
+        get(LIBPROPERTY__ADDRESSOF(value), sizeof(value));
+        access::set_bits<typename info_t::property_type>(host, value);
+      } else if constexpr (info_t::kind != property_kind::memoized) {
+        using value_t = snapshot_value_t<info_t>;
+        property = snapshot_traits<value_t>::read(get);
+      } else {
+        property.invalidate();
+      }
+    });
+  }
+
+  template <typename Host, typename Put>
+  void write_snapshot(Host const* first, std::size_t count, Put&& put)
+  {
+    auto const prefix = snapshot_prefix<Host>(count);
+    put(prefix.data(), prefix.size());
+    if constexpr (snapshot_in_place<Host>) {
+      put(first, count * sizeof(Host));
+    } else {
+      for (std::size_t i = 0; i < count; ++i) {
+        write_properties(first[i], put);
+      }
+    }
+  }
+} // impl
+
+/// A snapshot of the `count` hosts starting at `first`.
+template <typename Host>
+std::vector<char> make_snapshot(Host const* first, std::size_t count)
+{
+  std::vector<char> snapshot;
+  impl::write_snapshot(first, count, [&](void const* p, std::size_t n) {
+    auto const bytes = static_cast<char const*>(p);
+    snapshot.insert(snapshot.end(), bytes, bytes + n);
+  });
+  return snapshot;
+}
+
+/// Writes a snapshot of the `count` hosts starting at `first` to `out`.
+template <typename Host>
+void write_snapshot(std::ostream& out, Host const* first, std::size_t count)
+{
+  impl::write_snapshot(first, count, [&](void const* p, std::size_t n) {
+    out.write(static_cast<char const*>(p), static_cast<std::streamsize>(n));
+  });
+}
+
+/**
+ * A snapshot of `Host`s in memory, for example a file read or mapped into
+ * memory. The constructor checks the schema.
+ */
+template <typename Host>
+class snapshot_view {
+  char const* data_;
+  std::size_t size_;
+  impl::snapshot_header header_;
+
+  void check(bool condition, char const* what) const
+  {
+    if (!condition) {
+      throw snapshot_error(std::string("libproperty snapshot: ") + what);
+    }
+  }
+
+public:
+  snapshot_view(void const* data, std::size_t size)
+      : data_(static_cast<char const*>(data)), size_(size)
+  {
+    check(size_ >= sizeof(header_), "truncated header");
+    std::memcpy(&header_, data_, sizeof(header_));
+    check(std::memcmp(header_.magic, impl::snapshot_magic,
+              sizeof(header_.magic))
+            == 0,
+        "not a snapshot");
+
+    auto const expected = impl::snapshot_prefix<Host>(header_.count);
+    check(header_.data_offset == expected.size() && size_ >= expected.size()
+            && std::memcmp(data_, expected.data(), expected.size()) == 0,
+        "the schema does not match the host");
+    if constexpr (impl::snapshot_in_place<Host>) {
+      // divide rather than multiply: the count is untrusted and may overflow
+      check(header_.count <= (size_ - header_.data_offset) / sizeof(Host),
+          "truncated data");
+    }
+  }
+
+  std::size_t size() const noexcept
+  {
+    return static_cast<std::size_t>(header_.count);
+  }
+
+  /// The hosts, in place. Only for trivially copyable hosts.
+  Host const* data() const
+  {
+    static_assert(impl::snapshot_in_place<Host>,
+        "only trivially copyable, standard-layout hosts are stored in place");
+    auto const first = data_ + header_.data_offset;
+    check(reinterpret_cast<std::uintptr_t>(first) % alignof(Host) == 0,
+        "the snapshot is not aligned for the host");
+    return LIBPROPERTY__LAUNDER(reinterpret_cast<Host const*>(first));
+  }
+
+  /// Assigns the hosts in the snapshot to the `size()` hosts at `out`.
+  void restore(Host* out) const
+  {
+    char const* in = data_ + header_.data_offset;
+    if constexpr (impl::snapshot_in_place<Host>) {
+      std::memcpy(static_cast<void*>(out), in, size() * sizeof(Host));
+    } else {
+      impl::snapshot_reader get{ in, data_ + size_ };
+      for (std::size_t i = 0; i < size(); ++i) {
+        impl::read_properties(out[i], get);
+      }
+    }
+  }
+};
+
+} // libproperty
+
+#endif
@@ -0,0 +1,321 @@
+#ifndef INCLUDED_LIBPROPERTY_SOA_VECTOR_HPP
+#define INCLUDED_LIBPROPERTY_SOA_VECTOR_HPP
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015, 2017 Gašper Ažman
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "host_access.hpp"
+#include "property_impl.hpp"
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace libproperty {
+
+namespace impl {
+  /**
+   * What the column of a property that stores a `T` holds: `T`, except that
+   * `bool`s are kept as `unsigned char`s, 0 or 1. `std::vector<bool>` packs
+   * its elements into bits, which references cannot bind to.
+   */
+  template <typename T>
+  using column_value_t
+      = std::conditional_t<std::is_same_v<T, bool>, unsigned char, T>;
+} // impl
+
+/// A contiguous range of the values of one property, for scans.
+template <typename T>
+class column_span {
+  T* data_;
+  std::size_t size_;
+
+public:
+  constexpr column_span(T* data, std::size_t size) noexcept
+      : data_(data), size_(size)
+  {
+  }
+
+  constexpr T* data() const noexcept
+  {
+    return data_;
+  }
+  constexpr std::size_t size() const noexcept
+  {
+    return size_;
+  }
+  constexpr T* begin() const noexcept
+  {
+    return data_;
+  }
+  constexpr T* end() const noexcept
+  {
+    return data_ + size_;
+  }
+  constexpr T& operator[](std::size_t i) const noexcept
+  {
+    return data_[i];
+  }
+};
+
+/**
+ * A sequence of `Host`s stored as a structure of arrays: every property of
+ * `Host` gets a `std::vector` of its own.
+ *
+ * `vec[i]` is a lightweight element, and `vec[i][&Host::mass]` a reference to
+ * one property of it, which reads and writes through the host's getter and
+ * setter:
+ *
+ *   vec[i][&particle::mass] = 2.f;
+ *   float m = vec[i][&particle::mass];
+ *
+ * Each access moves that property's value from its column into a scratch
+ * `Host`, runs the accessor on it, and moves the value back; no other column
+ * is touched. With trivially copyable values and inlined accessors, the
+ * scratch host folds away: a read is a load from one column, and a write a
+ * store to it. The other members of the scratch host are value-initialized,
+ * not the element's: an accessor that reads any other member sees its
+ * default. Nothing detects that, so keep such hosts out of soa_vector.
+ *
+ * `column(&Host::mass)` is the contiguous storage of one property, for
+ * vectorized scans that do not need the accessors. Columns of `bool`s hold
+ * `unsigned char`s, 0 or 1.
+ *
+ * Only the properties of `Host` are stored. `Host` must be default
+ * constructible, and have no bitfield properties.
+ */
+template <typename Host, typename Tags = impl::properties_t<Host>>
+class soa_vector;
+
+template <typename Host, typename... Tags>
+class soa_vector<Host, impl::tag_list<Tags...>> {
+  static_assert(((property_traits_t<impl::property_of_t<Tags>>::kind
+                     != property_kind::bitfield)
+                    && ...),
+      "bitfield properties share a word and cannot be split into columns");
+
+  using indices = std::index_sequence_for<Tags...>;
+
+  std::tuple<std::vector<impl::column_value_t<impl::storage_t<Tags>>>...>
+      columns_;
+
+  template <typename Tag>
+  static constexpr std::size_t column_index
+      = impl::index_of<Tag, Tags...>();
+
+  template <typename H, std::size_t... I>
+  void append(H&& host, std::index_sequence<I...>)
+  {
+    (std::get<I>(columns_).push_back(
+         impl::access::value(LIBPROPERTY__FORWARD(host).*Tags::member())),
+        ...);
+  }
+
+  /// Puts a value moved out of its column back when it goes out of scope.
+  template <typename Slot, typename T>
+  struct put_back {
+    Slot& slot;
+    T& value;
+
+    ~put_back()
+    {
+      slot = std::move(value);
+    }
+  };
+
+  /// Runs `f` on a scratch host holding the value of `Tag` at `index`.
+  template <typename Tag, typename Vector, typename F>
+  static decltype(auto) with_host(Vector& vector, std::size_t index, F&& f)
+  {
+    Host host = Host(); // value-initialized, not aggregate-initialized
+    auto& slot = std::get<column_index<Tag>>(vector.columns_)[index];
+    auto& value = impl::access::value(host.*Tag::member());
+    if constexpr (std::is_const_v<Vector>) {
+      value = slot;
+      return LIBPROPERTY__FORWARD(f)(std::as_const(host));
+    } else {
+      value = std::move(slot);
+      put_back<std::remove_reference_t<decltype(slot)>,
+          impl::storage_t<Tag>> const guard{ slot, value };
+      return LIBPROPERTY__FORWARD(f)(host);
+    }
+  }
+
+  template <typename Vector, typename Tag>
+  class basic_reference {
+    Vector* vector_;
+    std::size_t index_;
+
+  public:
+    /// What reading the property returns, as a value.
+    using value_type = std::decay_t<decltype(::libproperty::get(
+        std::declval<Host const&>(), Tag::member()))>;
+
+    constexpr basic_reference(Vector& vector, std::size_t index) noexcept
+        : vector_(&vector), index_(index)
+    {
+    }
+
+    value_type get() const
+    {
+      return with_host<Tag>(*vector_, index_, [](auto& host) -> value_type {
+        return ::libproperty::get(host, Tag::member());
+      });
+    }
+    operator value_type() const
+    {
+      return get();
+    }
+
+    template <typename X,
+        typename V = Vector,
+        typename = std::enable_if_t<!std::is_const_v<V>>>
+    basic_reference const& operator=(X&& x) const
+    {
+      with_host<Tag>(*vector_, index_, [&](Host& host) {
+        ::libproperty::set(host, Tag::member(), LIBPROPERTY__FORWARD(x));
+      });
+      return *this;
+    }
+    basic_reference const& operator=(basic_reference const& other) const
+    {
+      return *this = other.get();
+    }
+
+    /// `host.property.modify(f)`; returns what `f` returns, by value.
+    template <typename F,
+        typename V = Vector,
+        typename = std::enable_if_t<!std::is_const_v<V>>>
+    auto modify(F&& f) const
+    {
+      return with_host<Tag>(*vector_, index_, [&](Host& host) {
+        return (host.*Tag::member()).modify(LIBPROPERTY__FORWARD(f));
+      });
+    }
+  };
+
+  template <typename Vector>
+  class basic_element {
+    Vector* vector_;
+    std::size_t index_;
+
+  public:
+    constexpr basic_element(Vector& vector, std::size_t index) noexcept
+        : vector_(&vector), index_(index)
+    {
+    }
+
+    template <typename Property>
+    constexpr auto operator[](Property Host::*) const noexcept
+    {
+      using tag = typename property_traits<Property>::tag;
+      return basic_reference<Vector, tag>{ *vector_, index_ };
+    }
+  };
+
+public:
+  using value_type = Host;
+  using size_type = std::size_t;
+  using element = basic_element<soa_vector>;
+  using const_element = basic_element<soa_vector const>;
+  template <typename Property>
+  using reference
+      = basic_reference<soa_vector, typename property_traits<Property>::tag>;
+  template <typename Property>
+  using const_reference = basic_reference<soa_vector const,
+      typename property_traits<Property>::tag>;
+
+  static constexpr std::size_t columns = sizeof...(Tags);
+
+  soa_vector() = default;
+
+  size_type size() const noexcept
+  {
+    return std::get<0>(columns_).size();
+  }
+  bool empty() const noexcept
+  {
+    return size() == 0;
+  }
+
+  void reserve(size_type n)
+  {
+    std::apply([n](auto&... column) { (column.reserve(n), ...); }, columns_);
+  }
+  void clear() noexcept
+  {
+    std::apply([](auto&... column) { (column.clear(), ...); }, columns_);
+  }
+  void pop_back()
+  {
+    std::apply([](auto&... column) { (column.pop_back(), ...); }, columns_);
+  }
+
+  void push_back(Host const& host)
+  {
+    append(host, indices{});
+  }
+  void push_back(Host&& host)
+  {
+    append(std::move(host), indices{});
+  }
+  template <typename... Args>
+  void emplace_back(Args&&... args)
+  {
+    push_back(Host(std::forward<Args>(args)...));
+  }
+
+  element operator[](size_type i) noexcept
+  {
+    return { *this, i };
+  }
+  const_element operator[](size_type i) const noexcept
+  {
+    return { *this, i };
+  }
+
+  template <typename Property>
+  auto column(Property Host::*)
+  {
+    using tag = typename property_traits<Property>::tag;
+    auto& c = std::get<column_index<tag>>(columns_);
+    return column_span<impl::column_value_t<impl::storage_t<tag>>>{ c.data(),
+      c.size() };
+  }
+  template <typename Property>
+  auto column(Property Host::*) const
+  {
+    using tag = typename property_traits<Property>::tag;
+    auto& c = std::get<column_index<tag>>(columns_);
+    return column_span<impl::column_value_t<impl::storage_t<tag>> const>{
+      c.data(), c.size()
+    };
+  }
+};
+
+} // libproperty
+
+#endif
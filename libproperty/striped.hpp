@@ -0,0 +1,165 @@
+#ifndef INCLUDED_LIBPROPERTY_STRIPED_HPP
+#define INCLUDED_LIBPROPERTY_STRIPED_HPP
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015, 2017 Gašper Ažman
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "config.hpp"
+#include "meta.hpp"
+#include "wrapper.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <type_traits>
+#include <utility>
+
+// A wrapped property guarded by a lock from the global stripe table.
+#define LIBPROPERTY_STRIPED(type, name, host)                                  \
+  LIBPROPERTY_WRAP(                                                            \
+      (::libproperty::striped<LIBPROPERTY__PARENTHESIZED_TYPE type>),          \
+      name,                                                                    \
+      host)
+
+namespace libproperty {
+
+/// A test-and-test-and-set lock, for stripes that are held very briefly.
+class spinlock {
+  std::atomic<bool> locked_{ false };
+
+public:
+  bool try_lock() noexcept
+  {
+    return !locked_.load(std::memory_order_relaxed)
+        && !locked_.exchange(true, std::memory_order_acquire);
+  }
+  void lock() noexcept
+  {
+    while (!try_lock()) {
+      LIBPROPERTY__CPU_RELAX();
+    }
+  }
+  void unlock() noexcept
+  {
+    locked_.store(false, std::memory_order_release);
+  }
+};
+
+namespace impl {
+  constexpr std::size_t cache_line = LIBPROPERTY__CACHE_LINE;
+
+  template <typename Mutex>
+  struct alignas(cache_line) padded_stripe {
+    Mutex mutex;
+  };
+
+  template <typename Mutex, std::size_t Stripes>
+  inline padded_stripe<Mutex> stripe_table[Stripes];
+
+  template <typename Mutex>
+  using lock_shared_t = decltype(std::declval<Mutex&>().lock_shared());
+
+  /// Fibonacci hashing of the address; hosts are at least word-aligned.
+  template <std::size_t Stripes>
+  inline std::size_t stripe_index(void const* host) noexcept
+  {
+    static_assert(Stripes > 0 && (Stripes & (Stripes - 1)) == 0,
+        "the stripe count must be a power of two");
+    auto const bits = reinterpret_cast<std::uintptr_t>(host) >> 3;
+    return static_cast<std::size_t>(
+               (bits * std::uint64_t{ 0x9e3779b97f4a7c15 }) >> 32)
+        & (Stripes - 1);
+  }
+} // impl
+
+/**
+ * `wrapper` policy that guards the value with a lock from a global table of
+ * `Stripes` cache-line-padded `Mutex`es, picked by hashing the host's address.
+ * The host only stores the value.
+ *
+ * Reading the property copies the value under the stripe in shared mode (if
+ * `Mutex` has one), and assigning, `modify(f)` and the compound operators hold
+ * it exclusively. All striped properties of one host share its stripe, but so
+ * may unrelated hosts: `f` must not access any striped property, and hosts
+ * must not be copied or destroyed while other threads access them.
+ *
+ * Every combination of `Mutex` and `Stripes` gets a table of its own.
+ */
+template <typename T,
+    typename Mutex = std::shared_mutex,
+    std::size_t Stripes = LIBPROPERTY_STRIPES>
+class striped {
+  T value_;
+
+  template <typename Host>
+  static Mutex& stripe(Host const& host) noexcept
+  {
+    return impl::stripe_table<Mutex, Stripes>[impl::stripe_index<Stripes>(
+                                                   LIBPROPERTY__ADDRESSOF(host))]
+        .mutex;
+  }
+
+public:
+  using value_type = T;
+  using mutex_type = Mutex;
+  static constexpr std::size_t stripes = Stripes;
+
+  striped() = default;
+  constexpr striped(T x) noexcept(std::is_nothrow_move_constructible_v<T>)
+      : value_(std::move(x))
+  {
+  }
+
+  /* the wrapper protocol */
+  template <typename Host>
+  T get(Host const& host) const
+  {
+    if constexpr (meta::is_detected_v<impl::lock_shared_t, Mutex>) {
+      std::shared_lock<Mutex> lock{ stripe(host) };
+      return value_;
+    } else {
+      std::lock_guard<Mutex> lock{ stripe(host) };
+      return value_;
+    }
+  }
+  template <typename Host, typename X>
+  void set(Host const& host, X&& x)
+  {
+    std::lock_guard<Mutex> lock{ stripe(host) };
+    value_ = std::forward<X>(x);
+  }
+  /// `f` runs with the stripe held exclusively; returns a copy of its result.
+  template <typename Host, typename F>
+  auto modify(Host const& host, F&& f)
+  {
+    std::lock_guard<Mutex> lock{ stripe(host) };
+    return std::forward<F>(f)(value_);
+  }
+};
+
+} // libproperty
+
+#endif
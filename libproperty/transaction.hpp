@@ -0,0 +1,275 @@
+#ifndef INCLUDED_LIBPROPERTY_TRANSACTION_HPP
+#define INCLUDED_LIBPROPERTY_TRANSACTION_HPP
+
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015, 2017 Gašper Ažman
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/*
+ * Transactions: several writes to one host, with one lock, one validation
+ * and one notification around all of them instead of around each.
+ *
+ *   libproperty::transaction(host, [](auto& tx) {
+ *     tx.x = 1;
+ *     tx.y = 2;
+ *   });
+ *
+ * `tx` is the host itself, so the writes go through the usual setters and
+ * policies. What a transaction adds is the host's commit hook, declared with
+ * LIBPROPERTY_COMMIT, which runs around the whole body, and
+ * `libproperty::in_transaction(host)`, which setters can check to leave the
+ * locking, validating and notifying to the hook.
+ *
+ * Writes take effect as they are made, so that the hook can validate the
+ * host as it will be. If the hook throws, say because validation failed, the
+ * transaction sets the properties back to what they were before it, and
+ * rethrows. That takes a copy of every property's value at the start of each
+ * transaction; hosts declared with LIBPROPERTY_COMMIT_NO_ROLLBACK skip it.
+ */
+
+#include "config.hpp"
+#include "host_access.hpp"
+#include "meta.hpp"
+#include "property_impl.hpp"
+
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Optional: `host.commit(body)` must call `body()`, which makes all the writes
+// of a transaction, exactly once, and does whatever has to happen once per
+// transaction around it. Only call in class scope.
+#define LIBPROPERTY_COMMIT(commit, host)                                       \
+  template <typename F>                                                        \
+  auto static _libproperty__commit(host& h, F&& body)->decltype(auto)          \
+  {                                                                            \
+    return h.commit(static_cast<F&&>(body));                                   \
+  }                                                                            \
+  static_assert(true, "require semicolon")
+
+// Like LIBPROPERTY_COMMIT, but nothing is saved when a transaction starts, and
+// a hook that throws leaves the writes of the transaction as they were made.
+// Only call in class scope.
+#define LIBPROPERTY_COMMIT_NO_ROLLBACK(commit, host)                           \
+  LIBPROPERTY_COMMIT(commit, host);                                            \
+  using _libproperty__no_rollback = void
+
+namespace libproperty {
+namespace impl {
+
+  template <typename Host, typename F>
+  using commit_hook_t = decltype(Host::_libproperty__commit(
+      std::declval<Host&>(), std::declval<F>()));
+
+  /// The transactions open on this thread, innermost first.
+  struct open_transaction {
+    void const* host;
+    open_transaction const* outer;
+
+    static open_transaction const*& innermost() noexcept
+    {
+      thread_local open_transaction const* list = nullptr;
+      return list;
+    }
+
+    explicit open_transaction(void const* h) noexcept
+        : host(h)
+        , outer(innermost())
+    {
+      innermost() = this;
+    }
+    open_transaction(open_transaction const&) = delete;
+    open_transaction& operator=(open_transaction const&) = delete;
+    ~open_transaction()
+    {
+      innermost() = outer;
+    }
+  };
+
+  template <typename Host>
+  using no_rollback_t = typename Host::_libproperty__no_rollback;
+
+  struct not_saved {
+  };
+
+  /// What a transaction saves of the property of `Tag`: a copy of what its
+  /// getter returns, if it can be assigned back through the setter.
+  template <typename Tag,
+      bool = property_traits_t<property_of_t<Tag>>::kind
+          == property_kind::memoized>
+  struct saved_value {
+    using read_t = decltype(::libproperty::get(
+        std::declval<typename Tag::host_type const&>(), Tag::member()));
+    using value_t = std::decay_t<read_t>;
+    using type = std::conditional_t<std::is_constructible_v<value_t, read_t>
+            && std::is_assignable_v<property_of_t<Tag>&, value_t&&>,
+        value_t,
+        not_saved>;
+  };
+  template <typename Tag>
+  struct saved_value<Tag, true> {
+    using type = not_saved;
+  };
+  template <typename Tag>
+  using saved_t = typename saved_value<Tag>::type;
+
+  /// The properties of a host as they were at the start of a transaction.
+  template <typename Host, typename List = properties_t<Host>>
+  class saved_properties;
+  template <typename Host, typename... Tags>
+  class saved_properties<Host, tag_list<Tags...>> {
+    std::tuple<saved_t<Tags>...> saved_;
+
+    template <typename Tag>
+    static saved_t<Tag> save(Host const& host)
+    {
+      if constexpr (std::is_same_v<saved_t<Tag>, not_saved>) {
+        static_cast<void>(host);
+        return {};
+      } else {
+        return ::libproperty::get(host, Tag::member());
+      }
+    }
+    /// Through the setter, so that policies such as journaled see it.
+    template <typename Tag>
+    static void restore(Host& host, saved_t<Tag>& saved)
+    {
+      if constexpr (!std::is_same_v<saved_t<Tag>, not_saved>) {
+        host.*Tag::member() = std::move(saved);
+      } else if constexpr (property_traits_t<property_of_t<Tag>>::kind
+          == property_kind::memoized) {
+        (host.*Tag::member()).invalidate();
+      } else {
+        static_cast<void>(host);
+        static_cast<void>(saved);
+      }
+    }
+
+  public:
+    explicit saved_properties(Host const& host)
+        : saved_(save<Tags>(host)...)
+    {
+    }
+
+    void restore(Host& host)
+    {
+      std::apply(
+          [&](auto&... saved) { (restore<Tags>(host, saved), ...); }, saved_);
+    }
+  };
+
+  /// Runs the commit hook, and puts the properties back if it throws.
+  template <typename Host, typename Body>
+  void commit(Host& host, Body&& body)
+  {
+    bool ran = false;
+    auto const run = [&] {
+      ran = true;
+      LIBPROPERTY__FORWARD(body)();
+    };
+    if constexpr (meta::is_detected_v<properties_t, Host>
+        && !meta::is_detected_v<no_rollback_t, Host>) {
+      saved_properties<Host> saved{ host };
+      try {
+        Host::_libproperty__commit(host, run);
+      } catch (...) {
+        saved.restore(host);
+        throw;
+      }
+    } else {
+      Host::_libproperty__commit(host, run);
+    }
+    if (!ran) {
+      throw std::logic_error(
+          "libproperty transaction: the commit hook did not run the body");
+    }
+  }
+
+} // impl
+
+/// Whether this thread is inside a transaction on `host`.
+template <typename Host>
+bool in_transaction(Host const& host) noexcept
+{
+  void const* const address = LIBPROPERTY__ADDRESSOF(host);
+  for (auto const* t = impl::open_transaction::innermost(); t != nullptr;
+       t = t->outer) {
+    if (t->host == address) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Runs `f(host)` as one transaction on `host`, inside the host's commit hook
+ * if it has one. Writes take effect as they are made. If the hook throws, the
+ * properties of `host` get back the values they had before the transaction,
+ * read through their getters when it starts and assigned back through their
+ * setters, still inside the transaction; memoized ones are invalidated.
+ * Properties that cannot be assigned what their getter returns are not
+ * restored, and neither is anything with LIBPROPERTY_COMMIT_NO_ROLLBACK. The
+ * hook must run the body exactly once; a hook that returns without running it
+ * makes this throw std::logic_error.
+ *
+ * A transaction on a host that is already in one on this thread just runs
+ * `f(host)`, and leaves committing, and rolling back, to the outer one.
+ *
+ * Returns what `f` returns, by value if there is a commit hook.
+ */
+template <typename Host, typename F>
+decltype(auto) transaction(Host& host, F&& f)
+{
+  namespace pi = ::libproperty::impl;
+  namespace pm = ::libproperty::meta;
+  using body_t = void (*)();
+  using result_t = std::invoke_result_t<F&&, Host&>;
+
+  if constexpr (pm::is_detected_v<pi::commit_hook_t, Host, body_t>) {
+    if constexpr (std::is_void_v<result_t>) {
+      if (in_transaction(host)) {
+        LIBPROPERTY__FORWARD(f)(host);
+        return;
+      }
+      pi::open_transaction const open{ LIBPROPERTY__ADDRESSOF(host) };
+      pi::commit(host, [&] { LIBPROPERTY__FORWARD(f)(host); });
+    } else {
+      if (in_transaction(host)) {
+        return std::decay_t<result_t>(LIBPROPERTY__FORWARD(f)(host));
+      }
+      pi::open_transaction const open{ LIBPROPERTY__ADDRESSOF(host) };
+      std::optional<std::decay_t<result_t>> result;
+      pi::commit(host, [&] { result.emplace(LIBPROPERTY__FORWARD(f)(host)); });
+      return std::decay_t<result_t>(std::move(*result));
+    }
+  } else {
+    pi::open_transaction const open{ LIBPROPERTY__ADDRESSOF(host) };
+    return LIBPROPERTY__FORWARD(f)(host);
+  }
+}
+
+} // libproperty
+
+#endif
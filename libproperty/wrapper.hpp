@@ -25,8 +25,12 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 */
 
+#include "instrument.hpp"
+#include "modify.hpp"
 #include "property_impl.hpp"
 
+#include <utility>
+
 #define LIBPROPERTY_WRAP(type, name, host)                                     \
   LIBPROPERTY__DECLARE_TAG(name, host);                                        \
   ::libproperty::wrapper<LIBPROPERTY__PARENTHESIZED_TYPE type,                 \
@@ -45,6 +49,7 @@ class wrapper {
 
   // allow `host` to access self::value
   friend host;
+  friend struct ::libproperty::impl::access;
   // the very first thing to make sure it shares the address with wrapper.
   Property value;
 
@@ -66,69 +71,196 @@ class wrapper {
       : value(x)
   {
   }
+  // in-place construction, for policies that can't be moved
+  template <typename... Args>
+  constexpr wrapper(std::in_place_t, Args&&... args) noexcept(
+      std::is_nothrow_constructible_v<value_type, Args&&...>)
+      : value(std::forward<Args>(args)...)
+  {
+  }
 
   /* get */
   template <typename V = value_type,
       typename H = host,
       typename = decltype(std::declval<V>().get(std::declval<H const&>())),
       bool nxc = noexcept(std::declval<V>().get(std::declval<H const&>()))>
-  auto get() const & noexcept(nxc) -> decltype(auto)
+  LIBPROPERTY__ACCESSOR auto get() const & noexcept(nxc) -> decltype(auto)
   {
+    [[maybe_unused]] ::libproperty::impl::probe<Tag,
+        ::libproperty::impl::access_kind::read> const probe{};
     return value.get(::libproperty::impl::get_host(*this));
   }
   template <typename V = value_type,
       typename H = host,
       typename = decltype(std::declval<V>().get(std::declval<H&>())),
       bool nxc = noexcept(std::declval<V>().get(std::declval<H&>()))>
-      auto get() & noexcept(nxc) -> decltype(auto)
+  LIBPROPERTY__ACCESSOR auto get() & noexcept(nxc) -> decltype(auto)
   {
+    [[maybe_unused]] ::libproperty::impl::probe<Tag,
+        ::libproperty::impl::access_kind::read> const probe{};
     return value.get(::libproperty::impl::get_host(*this));
   }
   template <typename V = value_type,
       typename H = host,
       typename = decltype(std::declval<V>().get(std::declval<H&&>())),
       bool nxc = noexcept(std::declval<V>().get(std::declval<H&&>()))>
-      auto get() && noexcept(nxc) -> decltype(auto)
+  LIBPROPERTY__ACCESSOR auto get() && noexcept(nxc) -> decltype(auto)
   {
-    return value.get(::libproperty::impl::get_host(std::move(*this)));
+    [[maybe_unused]] ::libproperty::impl::probe<Tag,
+        ::libproperty::impl::access_kind::read> const probe{};
+    return value.get(
+        ::libproperty::impl::get_host(static_cast<self&&>(*this)));
   }
 
 public:
   /* setter implementation */
-  template <typename X>
-  decltype(auto) operator=(X&& val) &
+  template <typename X,
+      typename = std::enable_if_t<!std::is_same_v<std::decay_t<X>, wrapper>>,
+      typename V = value_type,
+      typename H = host,
+      typename = decltype(
+          std::declval<V&>().set(std::declval<H&>(), std::declval<X>())),
+      bool nxc = noexcept(
+          std::declval<V&>().set(std::declval<H&>(), std::declval<X>()))>
+  LIBPROPERTY__ACCESSOR decltype(auto) operator=(X&& val) & noexcept(nxc)
   {
-    return value.set(
-        ::libproperty::impl::get_host(*this), std::forward<X>(val));
+    namespace pi = ::libproperty::impl;
+    [[maybe_unused]] pi::probe<Tag, pi::access_kind::write> const probe{};
+    auto& h = pi::get_host(*this);
+    [[maybe_unused]] auto const written = pi::invalidate_after_write<self>(h);
+    return value.set(h, LIBPROPERTY__FORWARD(val));
   }
-  template <typename X>
-  decltype(auto) operator=(X&& val) const &
+  template <typename X,
+      typename = std::enable_if_t<!std::is_same_v<std::decay_t<X>, wrapper>>,
+      typename V = value_type,
+      typename H = host,
+      typename = decltype(
+          std::declval<V const&>().set(std::declval<H&>(), std::declval<X>())),
+      bool nxc = noexcept(
+          std::declval<V const&>().set(std::declval<H&>(), std::declval<X>()))>
+  LIBPROPERTY__ACCESSOR decltype(auto) operator=(X&& val) const & noexcept(nxc)
   {
-    return value.set(
-        ::libproperty::impl::get_host(*this), std::forward<X>(val));
+    namespace pi = ::libproperty::impl;
+    [[maybe_unused]] pi::probe<Tag, pi::access_kind::write> const probe{};
+    auto& h = pi::get_host(*this);
+    [[maybe_unused]] auto const written = pi::invalidate_after_write<self>(h);
+    return value.set(h, LIBPROPERTY__FORWARD(val));
   }
-  template <typename X>
-  decltype(auto) operator=(X&& val) &&
+  template <typename X,
+      typename = std::enable_if_t<!std::is_same_v<std::decay_t<X>, wrapper>>,
+      typename V = value_type,
+      typename H = host,
+      typename = decltype(
+          std::declval<V&>().set(std::declval<H&&>(), std::declval<X>())),
+      bool nxc = noexcept(
+          std::declval<V&>().set(std::declval<H&&>(), std::declval<X>()))>
+  LIBPROPERTY__ACCESSOR decltype(auto) operator=(X&& val) && noexcept(nxc)
   {
-    return value.set(
-        ::libproperty::impl::get_host(std::move(*this)), std::forward<X>(val));
+    namespace pi = ::libproperty::impl;
+    [[maybe_unused]] pi::probe<Tag, pi::access_kind::write> const probe{};
+    auto&& h = pi::get_host(static_cast<self&&>(*this));
+    [[maybe_unused]] auto const written = pi::invalidate_after_write<self>(h);
+    return value.set(LIBPROPERTY__FORWARD(h), LIBPROPERTY__FORWARD(val));
   }
 
+  /**
+   * `a.w = b.w` reads `b.w` and sets `a.w` through the policy, like any other
+   * value. Only the host's own copy assignment copies the policy's storage,
+   * through the private copy assignment above, which keeps hosts trivially
+   * copyable. That one is also the exact match for a const or expiring
+   * `b.w`, so write `a.w = b.w.get()` for those.
+   */
+  template <typename W,
+      typename = std::enable_if_t<std::is_same_v<W, wrapper>>,
+      typename = decltype(std::declval<W&>() = std::declval<W&>().get()),
+      bool nxc = noexcept(std::declval<W&>() = std::declval<W&>().get())>
+  LIBPROPERTY__ACCESSOR decltype(auto) operator=(W& other) & noexcept(nxc)
+  {
+    return *this = other.get();
+  }
+
+  /* in-place modification */
+  /**
+   * Apply `f` to the value in place, through the policy's
+   * `modify(host, f)` if it has one, or else to a copy obtained from `get`,
+   * which is then passed to `set`. Returns what `f` returns.
+   */
+  template <typename F>
+  LIBPROPERTY__ACCESSOR decltype(auto) modify(F&& f)
+  {
+    namespace pi = ::libproperty::impl;
+    namespace pm = ::libproperty::meta;
+
+    [[maybe_unused]] pi::probe<Tag, pi::access_kind::write> const probe{};
+    auto& h = pi::get_host(*this);
+    [[maybe_unused]] auto const written = pi::invalidate_after_write<self>(h);
+    if constexpr (pm::is_detected_v<pi::policy_modify_t, value_type, host,
+                      F&&>) {
+      return value.modify(h, LIBPROPERTY__FORWARD(f));
+    } else {
+      return pi::modify_copy(std::as_const(*this).get(),
+          LIBPROPERTY__FORWARD(f),
+          [this, &h](auto&& v) { value.set(h, std::move(v)); });
+    }
+  }
+
+  /**
+   * Apply `op(value, args...)` in place, through the policy's
+   * `compound(host, op, args...)` if it has one, or else through `modify`.
+   */
+  template <typename Op, typename... Args>
+  LIBPROPERTY__ACCESSOR decltype(auto) compound(Op op, Args&&... args)
+  {
+    namespace pi = ::libproperty::impl;
+    namespace pm = ::libproperty::meta;
+
+    if constexpr (pm::is_detected_v<pi::policy_compound_t, value_type, host,
+                      Op, Args&&...>) {
+      [[maybe_unused]] pi::probe<Tag, pi::access_kind::write> const probe{};
+      auto& h = pi::get_host(*this);
+      [[maybe_unused]] auto const written
+          = pi::invalidate_after_write<self>(h);
+      return value.compound(h, op, LIBPROPERTY__FORWARD(args)...);
+    } else {
+      return modify([&](auto& v) -> decltype(auto) {
+        return op(v, LIBPROPERTY__FORWARD(args)...);
+      });
+    }
+  }
+
+  /// Whether `compound(Op{}, args...)` compiles; see modify.hpp.
+  template <typename Op, typename... Args>
+  static constexpr bool compound_applies
+      = ::libproperty::meta::is_detected_v<::libproperty::impl::
+                                               policy_compound_t,
+            value_type,
+            host,
+            Op,
+            Args...>
+      || std::is_invocable_v<Op,
+          std::decay_t<decltype(std::declval<wrapper const&>().get())>&,
+          Args...>;
+
+  LIBPROPERTY__DECLARE_COMPOUND_OPERATORS();
+
   /* implicit conversions to get */
   template <typename W = wrapper,
       bool nxc = noexcept(std::declval<W const&>().get())>
+  LIBPROPERTY__ACCESSOR
   operator decltype(std::declval<W const&>().get())() const & noexcept(nxc)
   {
     return get();
   }
   template <typename W = wrapper, bool nxc = noexcept(std::declval<W&>().get())>
-      operator decltype(std::declval<W&>().get())() & noexcept(nxc)
+  LIBPROPERTY__ACCESSOR
+  operator decltype(std::declval<W&>().get())() & noexcept(nxc)
   {
     return get();
   }
   template <typename W = wrapper,
       bool nxc = noexcept(std::declval<W&&>().get())>
-  operator decltype(std::declval<W&&>().get())() &&
+  LIBPROPERTY__ACCESSOR
+  operator decltype(std::declval<W&&>().get())() && noexcept(nxc)
   {
     return get();
   }
@@ -139,24 +271,36 @@ public:
       typename H = host,
       bool nxc = noexcept(
           std::declval<V>().template convert_to<U>(std::declval<H const&>()))>
-  operator U() const noexcept(nxc)
+  LIBPROPERTY__ACCESSOR operator U() const noexcept(nxc)
   {
+    [[maybe_unused]] ::libproperty::impl::probe<Tag,
+        ::libproperty::impl::access_kind::read> const probe{};
     return value.template convert_to<U>(::libproperty::impl::get_host(*this));
   }
 
 // operators
+// Only declared where the operator applies to what `get` returns.
 #define LIBPROPERTY__DECLARE_OPERATOR(op)                                      \
-  template <typename Y>                                                        \
-  friend decltype(auto) operator op(wrapper const& x, Y const& y)              \
+  template <typename Y, typename W = wrapper>                                  \
+  LIBPROPERTY__ACCESSOR friend auto operator op(wrapper const& x,              \
+      Y const& y) noexcept(noexcept(std::declval<W const&>().get() op y))      \
+      ->decltype(std::declval<W const&>().get() op y)                          \
   {                                                                            \
     return x.get() op y;                                                       \
   }                                                                            \
-  template <typename X>                                                        \
-  friend decltype(auto) operator op(X const& x, wrapper const& y)              \
+  template <typename X, typename W = wrapper>                                  \
+  LIBPROPERTY__ACCESSOR friend auto operator op(X const& x,                    \
+      wrapper const& y) noexcept(noexcept(x op std::declval<W const&>().get()))\
+      ->decltype(x op std::declval<W const&>().get())                          \
   {                                                                            \
     return x op y.get();                                                       \
   }                                                                            \
-  friend decltype(auto) operator op(wrapper const& x, wrapper const& y)        \
+  template <typename W = wrapper>                                              \
+  LIBPROPERTY__ACCESSOR friend auto operator op(wrapper const& x,              \
+      wrapper const& y) noexcept(noexcept(std::declval<W const&>().get()       \
+      op std::declval<W const&>().get()))                                      \
+      ->decltype(std::declval<W const&>().get()                                \
+          op std::declval<W const&>().get())                                   \
   {                                                                            \
     return x.get() op y.get();                                                 \
   }                                                                            \
@@ -181,7 +325,9 @@ public:
 template <typename P, typename Tag>
 struct property_traits<wrapper<P, Tag>> : std::true_type {
   static constexpr std::true_type is_property = {};
+  static constexpr property_kind kind = property_kind::wrapper;
   using tag = Tag;
+  using value_type = P; // the policy
   using meta = void; // wrapper does not use a meta.
 };
 
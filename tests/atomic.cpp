@@ -0,0 +1,92 @@
+#include "libproperty/atomic.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <thread>
+#include <vector>
+
+class stats {
+public:
+  LIBPROPERTY_ATOMIC((long), hits, stats);
+
+  stats()
+      : hits(std::in_place, 0)
+  {
+  }
+};
+static_assert(sizeof(stats) == sizeof(std::atomic<long>),
+    "An atomic property is supposed to be exactly its atomic!");
+
+class config {
+public:
+  // acquire/release is all a published flag needs
+  LIBPROPERTY_WRAP(
+      (libproperty::atomic<bool, std::memory_order_acq_rel>), ready, config);
+  LIBPROPERTY_ATOMIC((double), scale, config);
+
+  config()
+      : ready(std::in_place, false)
+      , scale(std::in_place, 1.0)
+  {
+  }
+};
+
+int main()
+{
+  {
+    stats s;
+    assert(s.hits == 0);
+    s.hits = 5l;
+    assert(s.hits == 5);
+    s.hits += 2;
+    s.hits -= 1;
+    assert(s.hits == 6);
+    assert(s.hits++ == 6);
+    assert((++s.hits) == 8);
+    assert(s.hits-- == 8);
+    assert(libproperty::fetch_add(s.hits, 10) == 7);
+    assert(libproperty::exchange(s.hits, 1) == 17);
+    long expected = 2;
+    assert(!libproperty::compare_exchange_strong(s.hits, expected, 3));
+    assert(expected == 1);
+    assert(libproperty::compare_exchange_strong(s.hits, expected, 3));
+    assert(libproperty::load(s.hits) == 3);
+    // no fetch_mul: compare-exchange loop
+    s.hits *= 4;
+    assert(s.hits == 12);
+    assert(s.hits.modify([](long& x) { return x /= 2; }) == 6);
+    assert(s.hits == 6);
+  }
+  {
+    stats s;
+    std::vector<std::thread> workers;
+    for (int i = 0; i < 4; ++i) {
+      workers.emplace_back([&s] {
+        for (int j = 0; j < 10000; ++j) {
+          ++s.hits;
+          s.hits += 2;
+          s.hits.modify([](long& x) { x -= 1; });
+        }
+      });
+    }
+    for (auto& w : workers) {
+      w.join();
+    }
+    assert(s.hits == 4 * 10000 * 2);
+  }
+  {
+    config c;
+    assert(!c.ready);
+    std::thread writer{ [&c] {
+      c.scale = 2.5;
+      c.ready = true;
+    } };
+    while (!c.ready) {
+    }
+    assert(c.scale == 2.5);
+    writer.join();
+    // no fetch_add for double in C++17: compare-exchange loop
+    c.scale += 0.5;
+    assert(c.scale == 3.0);
+  }
+}
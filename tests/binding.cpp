@@ -0,0 +1,220 @@
+#include "libproperty/binding.hpp"
+#include "libproperty/property.hpp"
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace lp = libproperty;
+
+int computed = 0;
+
+struct quote {
+  LIBPROPERTY_REACTIVE((double), price, quote);
+  LIBPROPERTY_REACTIVE((int), quantity, quote);
+  LIBPROPERTY_BOUND((double), total, quote);
+};
+
+/* a host that binds its own properties */
+struct label {
+  LIBPROPERTY_REACTIVE((std::string), first, label);
+  LIBPROPERTY_REACTIVE((std::string), last, label);
+  LIBPROPERTY_BOUND((std::string), full, label);
+
+  label()
+  {
+    lp::bind(full, std::plus<>{}, first, last);
+  }
+  label(label const& other)
+      : first(other.first)
+      , last(other.last)
+      , full(other.full)
+  {
+    lp::bind(full, std::plus<>{}, first, last);
+  }
+};
+
+static_assert(sizeof(lp::reactive<long>)
+    == sizeof(long) + sizeof(lp::impl::reactive_node));
+
+double times(double p, int q)
+{
+  ++computed;
+  return p * q;
+}
+
+int main()
+{
+  {
+    // lazy: writes mark, reads compute, once
+    quote q;
+    q.price = 2.0;
+    q.quantity = 3;
+    lp::bind(q.total, &times, q.price, q.quantity);
+    assert(lp::is_bound(q.total) && lp::is_stale(q.total));
+    assert(computed == 0);
+    assert(q.total == 6.0);
+    assert(q.total == 6.0);
+    assert(computed == 1);
+
+    q.price = 4.0;
+    q.quantity = 5;
+    q.quantity += 1;
+    assert(lp::is_stale(q.total) && computed == 1);
+    assert(q.total == 24.0);
+    assert(computed == 2);
+
+    // unbinding keeps the value
+    q.price = 1.0;
+    lp::unbind(q.total);
+    assert(!lp::is_bound(q.total) && computed == 3);
+    q.price = 10.0;
+    assert(q.total == 6.0 && computed == 3);
+  }
+  {
+    // chains across hosts, and diamonds, recompute each node once, in order
+    quote a;
+    quote b;
+    quote c;
+    a.price = 1.0;
+    a.quantity = 2;
+    lp::bind(a.total, &times, a.price, a.quantity); // a.total = a.p * a.q
+    b.quantity = 3;
+    lp::bind(b.total, &times, a.total, b.quantity); // b.total = a.total * b.q
+    c.quantity = 4;
+    lp::bind(c.total, &times, a.total, c.quantity); // c.total = a.total * c.q
+
+    quote top;
+    int top_computed = 0;
+    lp::bind(
+        top.total,
+        [&](double x, double y) {
+          ++top_computed;
+          return x + y;
+        },
+        b.total,
+        c.total);
+
+    computed = 0;
+    assert(top.total == 2.0 * 3 + 2.0 * 4);
+    assert(computed == 3 && top_computed == 1);
+
+    // a write deep down marks everything above it, reads see no mix of old
+    // and new values
+    a.price = 10.0;
+    assert(lp::is_stale(a.total) && lp::is_stale(b.total));
+    assert(lp::is_stale(top.total));
+    assert(top.total == 20.0 * 3 + 20.0 * 4);
+    assert(computed == 6 && top_computed == 2);
+
+    // only what depends on the write recomputes
+    b.quantity = 1;
+    assert(!lp::is_stale(a.total) && !lp::is_stale(c.total));
+    assert(top.total == 20.0 + 80.0);
+    assert(computed == 7 && top_computed == 3);
+
+    // cycles are rejected, and leave the binding as it was
+    bool threw = false;
+    try {
+      lp::bind(a.total, &times, top.total, a.quantity);
+    } catch (std::logic_error const&) {
+      threw = true;
+    }
+    assert(threw && lp::is_bound(a.total));
+    threw = false;
+    try {
+      lp::bind(a.total, &times, a.total, a.quantity);
+    } catch (std::logic_error const&) {
+      threw = true;
+    }
+    assert(threw);
+  }
+  {
+    // the cycle check visits each node once, however many paths lead to it
+    constexpr int layers = 64;
+    std::vector<std::array<quote, 2>> lattice(layers);
+    for (auto& q : lattice[0]) {
+      q.price = 1.0;
+      q.quantity = 1;
+      lp::bind(q.total, &times, q.price, q.quantity);
+    }
+    for (int k = 1; k < layers; ++k) {
+      for (auto& q : lattice[k]) {
+        lp::bind(q.total,
+            std::plus<>{},
+            lattice[k - 1][0].total,
+            lattice[k - 1][1].total);
+      }
+    }
+    assert(lattice[layers - 1][0].total == std::ldexp(1.0, layers - 1));
+    bool threw = false;
+    try {
+      lp::bind(lattice[0][0].total,
+          std::negate<>{},
+          lattice[layers - 1][1].total);
+    } catch (std::logic_error const&) {
+      threw = true;
+    }
+    assert(threw);
+  }
+  {
+    // reading the end of a long chain does not recurse down it
+    constexpr int length = 100000;
+    std::vector<quote> chain(length);
+    chain[0].price = 1.0;
+    chain[0].quantity = 1;
+    lp::bind(chain[0].total, &times, chain[0].price, chain[0].quantity);
+    for (int i = 1; i < length; ++i) {
+      chain[i].quantity = 1;
+      lp::bind(chain[i].total, &times, chain[i - 1].total, chain[i].quantity);
+    }
+    assert(chain[length - 1].total == 1.0);
+    chain[0].price = 2.0;
+    assert(lp::is_stale(chain[length - 1].total));
+    assert(chain[length - 1].total == 2.0);
+    assert(!lp::is_stale(chain[length / 2].total));
+  }
+  {
+    // destroying an input unbinds its dependents, which keep their value
+    quote q;
+    auto source = std::make_unique<quote>();
+    source->price = 3.0;
+    source->quantity = 2;
+    q.quantity = 2;
+    lp::bind(q.total, &times, source->price, q.quantity);
+    source->price = 5.0; // stale when the input goes
+    source.reset();
+    assert(!lp::is_bound(q.total));
+    assert(q.total == 10.0);
+    q.quantity = 7;
+    assert(q.total == 10.0);
+  }
+  {
+    // and destroying a dependent unlinks it from its inputs
+    quote q;
+    {
+      quote d;
+      lp::bind(d.total, &times, q.price, q.quantity);
+    }
+    q.price = 1.0;
+  }
+  {
+    label l;
+    l.first = std::string("Ada ");
+    l.last = std::string("Lovelace");
+    assert(static_cast<std::string const&>(l.full) == "Ada Lovelace");
+
+    // copies take the value; the host's copy constructor binds them again
+    label copy = l;
+    assert(static_cast<std::string const&>(copy.full) == "Ada Lovelace");
+    copy.first = std::string("Augusta Ada ");
+    assert(static_cast<std::string const&>(copy.full)
+        == "Augusta Ada Lovelace");
+    assert(static_cast<std::string const&>(l.full) == "Ada Lovelace");
+  }
+}
@@ -0,0 +1,151 @@
+#include "libproperty/bitfield.hpp"
+#include "libproperty/dirty.hpp"
+#include "libproperty/host_access.hpp"
+#include "libproperty/reflection.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+enum class shape : std::uint8_t { point, line, triangle, quad };
+
+/* a dozen small fields in one word */
+class entity {
+public:
+  LIBPROPERTY_BITFIELD((bool), visible, state, 0, 1, entity);
+  LIBPROPERTY_BITFIELD((bool), selected, state, 1, 1, entity);
+  LIBPROPERTY_BITFIELD((shape), kind, state, 2, 2, entity);
+  LIBPROPERTY_BITFIELD((unsigned), level, state, 4, 4, entity);
+  LIBPROPERTY_BITFIELD((int), delta, state, 8, 4, entity);
+  LIBPROPERTY_BITFIELD((unsigned), id, state, 12, 20, entity);
+  union {
+    std::uint32_t state = 0;
+    LIBPROPERTY_BITS(visible);
+    LIBPROPERTY_BITS(selected);
+    LIBPROPERTY_BITS(kind);
+    LIBPROPERTY_BITS(level);
+    LIBPROPERTY_BITS(delta);
+    LIBPROPERTY_BITS(id);
+  };
+};
+static_assert(sizeof(entity) == sizeof(std::uint32_t),
+    "Packed properties are supposed to be exactly their word!");
+
+/* the same three accessor-only properties as property_test in conformance.cpp
+ * each cost a char; packed, they share the host's word */
+struct packed_test {
+  LIBPROPERTY_BITFIELD((bool), prop1, bits, 0, 1, packed_test);
+  LIBPROPERTY_BITFIELD((bool), prop2, bits, 1, 1, packed_test);
+  LIBPROPERTY_BITFIELD((bool), prop3, bits, 2, 1, packed_test);
+  union {
+    std::uint8_t bits = 0;
+    LIBPROPERTY_BITS(prop1);
+    LIBPROPERTY_BITS(prop2);
+    LIBPROPERTY_BITS(prop3);
+  };
+};
+static_assert(sizeof(packed_test) == 1, "Three flags fit in one byte!");
+
+/* bitfields are properties like any other */
+static_assert(libproperty::property_count<entity> == 6);
+struct flags {
+  LIBPROPERTY_BITFIELD((bool), on, word, 0, 1, flags);
+  LIBPROPERTY_BITFIELD((unsigned), mode, word, 1, 3, flags);
+  union {
+    std::uint8_t word = 0;
+    LIBPROPERTY_BITS(on);
+    LIBPROPERTY_BITS(mode);
+  };
+  LIBPROPERTY_DIRTY_TRACKING(flags);
+};
+
+constexpr unsigned level_of(unsigned l)
+{
+  entity e;
+  libproperty::set(e, &entity::level, l);
+  return libproperty::get(e, &entity::level);
+}
+static_assert(level_of(5u) == 5u && level_of(17u) == 1u);
+
+int main()
+{
+  {
+    entity e;
+    assert(!e.visible && !e.selected);
+    e.visible = true;
+    e.kind = shape::triangle;
+    e.level = 9u;
+    e.delta = -3;
+    e.id = 0xabcdeu;
+    assert(e.visible && !e.selected);
+    assert(e.kind == shape::triangle);
+    assert(e.level == 9u);
+    assert(e.delta == -3);
+    assert(e.id == 0xabcdeu);
+
+    // the neighbours are left alone
+    e.level = 0u;
+    e.delta = 7;
+    e.selected = true;
+    assert(e.visible && e.selected && e.kind == shape::triangle);
+    assert(e.delta == 7 && e.id == 0xabcdeu);
+
+    // out-of-range values wrap, as they do for bit-fields
+    e.level = 17u;
+    assert(e.level == 1u);
+    e.delta = -9;
+    assert(e.delta == 7);
+
+    // compound operators and modify
+    e.level += 4u;
+    ++e.level;
+    assert(e.level == 6u);
+    assert(e.delta-- == 7);
+    e.delta -= 10;
+    assert(e.delta == -4);
+    assert(e.id.modify([](unsigned& id) { return id >>= 4; }) == 0xabcdu);
+    assert(e.id == 0xabcdu);
+
+    // hosts copy the word
+    entity f = e;
+    assert(f.kind == shape::triangle && f.id == 0xabcdu);
+    e = entity{};
+    assert(e.state == 0 && f.visible);
+  }
+  {
+    // reflection lists them in declaration order
+    std::string_view names[6];
+    std::size_t i = 0;
+    libproperty::for_each_property<entity>(
+        [&](auto info) { names[i++] = info.name; });
+    assert(names[0] == "visible" && names[5] == "id");
+    entity e;
+    unsigned sum = 0;
+    e.level = 3u;
+    e.id = 4u;
+    libproperty::for_each_property(e, [&](auto const& p, auto info) {
+      using info_t = decltype(info);
+      static_assert(
+          info_t::kind == libproperty::property_kind::bitfield);
+      sum += static_cast<unsigned>(
+          static_cast<typename info_t::value_type>(p));
+    });
+    assert(sum == 7u);
+
+    // writes mark them dirty, through the property or through the host
+    flags f;
+    f.mode = 2u;
+    assert(libproperty::is_dirty(f, &flags::mode));
+    assert(!libproperty::is_dirty(f, &flags::on));
+    libproperty::set(f, &flags::on, true);
+    assert(libproperty::is_dirty(f, &flags::on));
+    assert(f.on && f.mode == 2u && f.word == 5u);
+  }
+  {
+    std::vector<packed_test> xs(8);
+    xs[3].prop2 = true;
+    assert(xs[3].bits == 2);
+    assert(!xs[2].prop2 && !xs[4].prop2);
+  }
+}
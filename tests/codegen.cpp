@@ -0,0 +1,504 @@
+#include "libproperty/bitfield.hpp"
+#include "libproperty/property.hpp"
+#include "libproperty/reflection.hpp"
+#include "libproperty/soa_vector.hpp"
+
+#include <cstddef>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/*
+ * Reference translation unit for the codegen test: it is only compiled to
+ * assembly, and every `codegen_<variant>__<case>` function has to compile to
+ * exactly the same instructions as `codegen_raw__<case>`.
+ *
+ * This is what pins down the claim in `impl::get_host` that finding the host
+ * is a constant pointer adjustment, which folds away entirely once the
+ * accessors are inlined.
+ */
+
+struct large {
+  double data[16];
+};
+
+/* raw members */
+template <typename T>
+struct raw_host {
+  long before; // so that the property does not start at offset 0
+  T value;
+};
+
+/* rw_property */
+template <typename T>
+class rw_host {
+  using self = rw_host;
+
+  T const& get_value() const
+  {
+    return value.value;
+  }
+  T const& set_value(T const& x)
+  {
+    return value.value = x;
+  }
+
+public:
+  long before;
+  LIBPROPERTY_PROPERTY((T), value, get_value, set_value, self);
+};
+
+/* wrapper */
+template <typename T>
+class wrapper_host {
+  struct plain {
+    T value;
+
+    template <typename Host>
+    T const& get(Host const&) const
+    {
+      return value;
+    }
+    template <typename Host>
+    T const& set(Host&, T const& x)
+    {
+      return value = x;
+    }
+  };
+
+public:
+  long before;
+  LIBPROPERTY_WRAP((plain), value, wrapper_host);
+};
+
+/* a setter that uses the rest of the host, as in conformance.cpp */
+template <typename T>
+struct raw_write_protected {
+  bool writable;
+  T data;
+};
+
+template <typename T>
+class write_protected {
+  using self = write_protected;
+
+  constexpr T const& get_value() const
+  {
+    return data.value;
+  }
+  constexpr T const& set_value(T x)
+  {
+    if (writable) {
+      data.value = std::move(x);
+    }
+    return data.value;
+  }
+
+public:
+  bool writable;
+  LIBPROPERTY_PROPERTY((T), data, get_value, set_value, self);
+};
+
+/* a wrapper that reads the rest of the host through get_host */
+struct raw_scaled {
+  int scale;
+  int value;
+};
+
+class scaled {
+  struct times_scale {
+    int value;
+
+    int get(scaled const& host) const
+    {
+      return value * host.scale;
+    }
+    int get(scaled&& host) const
+    {
+      return value * host.scale;
+    }
+    void set(scaled& host, int x)
+    {
+      value = x / host.scale;
+    }
+  };
+
+public:
+  int scale;
+  LIBPROPERTY_WRAP((times_scale), value, scaled);
+};
+
+/* three properties, visited with for_each_property */
+struct raw_triple {
+  int a, b, c;
+};
+
+class triple {
+  using self = triple;
+
+  int const& get_a() const
+  {
+    return a.value;
+  }
+  int const& set_a(int x)
+  {
+    return a.value = x;
+  }
+  int const& get_b() const
+  {
+    return b.value;
+  }
+  int const& set_b(int x)
+  {
+    return b.value = x;
+  }
+  int const& get_c() const
+  {
+    return c.value;
+  }
+  int const& set_c(int x)
+  {
+    return c.value = x;
+  }
+
+public:
+  LIBPROPERTY_PROPERTY((int), a, get_a, set_a, self);
+  LIBPROPERTY_PROPERTY((int), b, get_b, set_b, self);
+  LIBPROPERTY_PROPERTY((int), c, get_c, set_c, self);
+};
+
+/* structure of arrays: one vector per property, as soa_vector stores them */
+struct raw_soa {
+  std::tuple<std::vector<float>, std::vector<float>, std::vector<float>>
+      columns;
+};
+
+class point {
+  using self = point;
+
+  float const& get_x() const
+  {
+    return x.value;
+  }
+  float const& set_x(float v)
+  {
+    return x.value = v;
+  }
+  float const& get_y() const
+  {
+    return y.value;
+  }
+  float const& set_y(float v)
+  {
+    return y.value = v;
+  }
+  float const& get_z() const
+  {
+    return z.value;
+  }
+  float const& set_z(float v)
+  {
+    return z.value = v;
+  }
+
+public:
+  LIBPROPERTY_PROPERTY((float), x, get_x, set_x, self);
+  LIBPROPERTY_PROPERTY((float), y, get_y, set_y, self);
+  LIBPROPERTY_PROPERTY((float), z, get_z, set_z, self);
+};
+
+/* bit-fields, by hand: flag in bit 0, level in bits 1-4, delta in bits 5-9 */
+struct raw_bits {
+  unsigned word;
+};
+
+struct packed_bits {
+  LIBPROPERTY_BITFIELD((bool), flag, word, 0, 1, packed_bits);
+  LIBPROPERTY_BITFIELD((unsigned), level, word, 1, 4, packed_bits);
+  LIBPROPERTY_BITFIELD((int), delta, word, 5, 5, packed_bits);
+  union {
+    unsigned word;
+    LIBPROPERTY_BITS(flag);
+    LIBPROPERTY_BITS(level);
+    LIBPROPERTY_BITS(delta);
+  };
+};
+
+extern "C" {
+
+/* int */
+int codegen_raw__read_int(raw_host<int> const& h)
+{
+  return h.value;
+}
+int codegen_rw_property__read_int(rw_host<int> const& h)
+{
+  return h.value;
+}
+int codegen_wrapper__read_int(wrapper_host<int> const& h)
+{
+  return h.value;
+}
+void codegen_raw__write_int(raw_host<int>& h, int x)
+{
+  h.value = x;
+}
+void codegen_rw_property__write_int(rw_host<int>& h, int x)
+{
+  h.value = x;
+}
+void codegen_wrapper__write_int(wrapper_host<int>& h, int x)
+{
+  h.value = x;
+}
+int codegen_host_access__read_int(rw_host<int> const& h)
+{
+  return libproperty::get(h, &rw_host<int>::value);
+}
+void codegen_host_access__write_int(rw_host<int>& h, int x)
+{
+  libproperty::set(h, &rw_host<int>::value, x);
+}
+int codegen_raw__arithmetic_int(raw_host<int> const& h, int x)
+{
+  return h.value * x + 1;
+}
+int codegen_wrapper__arithmetic_int(wrapper_host<int> const& h, int x)
+{
+  return h.value * x + 1;
+}
+bool codegen_raw__comparison_int(raw_host<int> const& h, int x)
+{
+  return h.value < x;
+}
+bool codegen_wrapper__comparison_int(wrapper_host<int> const& h, int x)
+{
+  return h.value < x;
+}
+
+/* rvalue hosts go through forward_like */
+int codegen_raw__read_rvalue_int(raw_host<int>& h)
+{
+  return std::move(h).value;
+}
+int codegen_rw_property__read_rvalue_int(rw_host<int>& h)
+{
+  return std::move(h).value;
+}
+int codegen_wrapper__read_rvalue_int(wrapper_host<int>& h)
+{
+  return std::move(h).value;
+}
+
+/* std::string */
+std::size_t codegen_raw__read_string(raw_host<std::string> const& h)
+{
+  std::string const& s = h.value;
+  return s.size();
+}
+std::size_t codegen_rw_property__read_string(rw_host<std::string> const& h)
+{
+  std::string const& s = h.value;
+  return s.size();
+}
+std::size_t codegen_wrapper__read_string(wrapper_host<std::string> const& h)
+{
+  std::string const& s = h.value;
+  return s.size();
+}
+void codegen_raw__write_string(
+    raw_host<std::string>& h, std::string const& x)
+{
+  h.value = x;
+}
+void codegen_rw_property__write_string(
+    rw_host<std::string>& h, std::string const& x)
+{
+  h.value = x;
+}
+void codegen_wrapper__write_string(
+    wrapper_host<std::string>& h, std::string const& x)
+{
+  h.value = x;
+}
+
+/* large aggregate */
+double codegen_raw__read_large(raw_host<large> const& h)
+{
+  large const& x = h.value;
+  return x.data[3];
+}
+double codegen_rw_property__read_large(rw_host<large> const& h)
+{
+  large const& x = h.value;
+  return x.data[3];
+}
+double codegen_wrapper__read_large(wrapper_host<large> const& h)
+{
+  large const& x = h.value;
+  return x.data[3];
+}
+void codegen_raw__write_large(raw_host<large>& h, large const& x)
+{
+  h.value = x;
+}
+void codegen_rw_property__write_large(rw_host<large>& h, large const& x)
+{
+  h.value = x;
+}
+void codegen_wrapper__write_large(wrapper_host<large>& h, large const& x)
+{
+  h.value = x;
+}
+
+/* templated host, setter that looks at another member */
+int codegen_raw__read_write_protected(raw_write_protected<int> const& h)
+{
+  return h.data;
+}
+int codegen_rw_property__read_write_protected(write_protected<int> const& h)
+{
+  return h.data;
+}
+void codegen_raw__write_write_protected(raw_write_protected<int>& h, int x)
+{
+  if (h.writable) {
+    h.data = x;
+  }
+}
+void codegen_rw_property__write_write_protected(write_protected<int>& h, int x)
+{
+  h.data = x;
+}
+
+/* wrapper policy that reads the host */
+int codegen_raw__read_scaled(raw_scaled const& h)
+{
+  return h.value * h.scale;
+}
+int codegen_wrapper__read_scaled(scaled const& h)
+{
+  return h.value;
+}
+int codegen_raw__read_rvalue_scaled(raw_scaled& h)
+{
+  return h.value * h.scale;
+}
+int codegen_wrapper__read_rvalue_scaled(scaled& h)
+{
+  return std::move(h).value;
+}
+void codegen_raw__write_scaled(raw_scaled& h, int x)
+{
+  h.value = x / h.scale;
+}
+void codegen_wrapper__write_scaled(scaled& h, int x)
+{
+  h.value = x;
+}
+
+/* for_each_property unrolls into straight-line code */
+int codegen_raw__sum_properties(raw_triple const& h)
+{
+  return h.a + h.b + h.c;
+}
+int codegen_reflection__sum_properties(triple const& h)
+{
+  int sum = 0;
+  libproperty::for_each_property(h, [&](auto const& property, auto) {
+    int const& value = property;
+    sum += value;
+  });
+  return sum;
+}
+
+/* soa_vector: an access touches the column of its property only */
+float codegen_raw__soa_read(raw_soa const& v, std::size_t i)
+{
+  return std::get<0>(v.columns)[i];
+}
+float codegen_soa_vector__soa_read(
+    libproperty::soa_vector<point> const& v, std::size_t i)
+{
+  return v[i][&point::x];
+}
+float codegen_raw__soa_read_mutable(raw_soa& v, std::size_t i)
+{
+  return std::get<1>(v.columns)[i];
+}
+float codegen_soa_vector__soa_read_mutable(
+    libproperty::soa_vector<point>& v, std::size_t i)
+{
+  return v[i][&point::y];
+}
+void codegen_raw__soa_write(raw_soa& v, std::size_t i, float x)
+{
+  std::get<2>(v.columns)[i] = x;
+}
+void codegen_soa_vector__soa_write(
+    libproperty::soa_vector<point>& v, std::size_t i, float x)
+{
+  v[i][&point::z] = x;
+}
+float codegen_raw__soa_sum(raw_soa const& v)
+{
+  auto const& xs = std::get<0>(v.columns);
+  float sum = 0;
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    sum += xs[i];
+  }
+  return sum;
+}
+float codegen_soa_vector__soa_sum(libproperty::soa_vector<point> const& v)
+{
+  float sum = 0;
+  for (std::size_t i = 0; i < v.size(); ++i) {
+    sum += v[i][&point::x];
+  }
+  return sum;
+}
+
+/* bit-fields: a shift and a mask on the word */
+unsigned codegen_raw__read_bits(raw_bits const& h)
+{
+  return (h.word >> 1) & 0xfu;
+}
+unsigned codegen_bitfield__read_bits(packed_bits const& h)
+{
+  return h.level;
+}
+bool codegen_raw__read_flag(raw_bits const& h)
+{
+  return h.word & 1u;
+}
+bool codegen_bitfield__read_flag(packed_bits const& h)
+{
+  return h.flag;
+}
+int codegen_raw__read_signed_bits(raw_bits const& h)
+{
+  return static_cast<int>(h.word << 22) >> 27;
+}
+int codegen_bitfield__read_signed_bits(packed_bits const& h)
+{
+  return h.delta;
+}
+void codegen_raw__write_bits(raw_bits& h, unsigned x)
+{
+  h.word = (h.word & ~0x1eu) | ((x & 0xfu) << 1);
+}
+void codegen_bitfield__write_bits(packed_bits& h, unsigned x)
+{
+  h.level = x;
+}
+void codegen_raw__write_signed_bits(raw_bits& h, int x)
+{
+  h.word = (h.word & ~0x3e0u) | ((static_cast<unsigned>(x) & 0x1fu) << 5);
+}
+void codegen_bitfield__write_signed_bits(packed_bits& h, int x)
+{
+  h.delta = x;
+}
+
+} // extern "C"
@@ -22,10 +22,35 @@ public:
   LIBPROPERTY_EMPTY_PROPERTY(prop2, get_value, set_value, self_);
   LIBPROPERTY_EMPTY_PROPERTY(prop3, get_value, set_value, self_);
 };
+#if LIBPROPERTY__EMPTY_TAKES_NO_SPACE
+/** with [[no_unique_address]], the properties take no room at all */
+static_assert(sizeof(property_test<0>) == sizeof(int),
+    "External property tester is supposed to be only its value!");
+#else
 /** consumes 8 bytes, because of alignment */
 static_assert(sizeof(property_test<0>) == sizeof(int) + sizeof(int),
     "External property tester is supposed to be only its value and"
     " the property alignment!");
+#endif
+
+/** a facade: nothing but computed properties */
+struct facade {
+  using self = facade;
+
+  int get_answer() const { return 42; }
+  int set_answer(int x) { return x; }
+  int get_double() const { return 2 * get_answer(); }
+  int set_double(int x) { return set_answer(x / 2); }
+
+  LIBPROPERTY_EMPTY_PROPERTY(answer, get_answer, set_answer, self);
+  LIBPROPERTY_EMPTY_PROPERTY(twice, get_double, set_double, self);
+};
+#if LIBPROPERTY__EMPTY_TAKES_NO_SPACE
+static_assert(sizeof(facade) == 1, "A facade is supposed to be empty!");
+#else
+static_assert(sizeof(facade) == 2, "A facade is supposed to be a char per"
+                                   " property!");
+#endif
 
 template <typename T>
 struct property_with_storage_test {
@@ -71,6 +96,15 @@ int main()
               << " prop2 offset: "
               << libproperty::impl::offset_of(x.prop2)
               << '\n';
+    // the properties find their host wherever they are
+    assert(x.prop1 == 5 && x.prop2 == 5 && x.prop3 == 5);
+    x.prop3 = 7;
+    assert(x.value_ == 7 && y.prop1 == 5);
+  }
+  {
+    facade f;
+    assert(f.answer == 42);
+    assert(f.twice == 84);
   }
   {
     property_with_storage_test<int> x;
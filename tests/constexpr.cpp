@@ -0,0 +1,74 @@
+#include "libproperty/property.hpp"
+
+#include <array>
+#include <cassert>
+
+class setting {
+  using self = setting;
+
+  constexpr int const& get_level() const
+  {
+    return level.value;
+  }
+  constexpr int const& set_level(int x)
+  {
+    return level.value = x < 0 ? 0 : x;
+  }
+
+  struct percent {
+    int value;
+
+    template <typename Host>
+    constexpr int get(Host const&) const
+    {
+      return value;
+    }
+    template <typename Host>
+    constexpr void set(Host const& host, int x)
+    {
+      // reads another property of the host
+      value = libproperty::get(host, &setting::level) > 0 && x > 100 ? 100 : x;
+    }
+  };
+
+public:
+  LIBPROPERTY_PROPERTY((int), level, get_level, set_level, self);
+  LIBPROPERTY_WRAP((percent), ratio, self);
+
+  constexpr setting()
+      : level(0)
+      , ratio(percent{ 0 })
+  {
+  }
+};
+
+/* a lookup table, computed at compile time */
+constexpr std::array<setting, 4> make_table()
+{
+  std::array<setting, 4> table{};
+  for (std::size_t i = 0; i < table.size(); ++i) {
+    libproperty::set(table[i], &setting::level, int(i) * 10 - 5);
+    libproperty::set(table[i], &setting::ratio, int(i) * 60);
+  }
+  return table;
+}
+constexpr auto table = make_table();
+
+static_assert(libproperty::get(table[0], &setting::level) == 0);
+static_assert(libproperty::get(table[2], &setting::level) == 15);
+static_assert(libproperty::get(table[0], &setting::ratio) == 0);
+static_assert(libproperty::get(table[1], &setting::ratio) == 60);
+static_assert(libproperty::get(table[2], &setting::ratio) == 100);
+
+int main()
+{
+  // the same accesses, at runtime
+  auto t = table;
+  assert(t[3].level == 25);
+  t[3].level = -1;
+  assert(libproperty::get(t[3], &setting::level) == 0);
+  libproperty::set(t[3], &setting::level, 7);
+  assert(t[3].level == 7);
+  int const ratio = t[3].ratio;
+  assert(ratio == 100);
+}
@@ -0,0 +1,149 @@
+#include "libproperty/dirty.hpp"
+#include "libproperty/property.hpp"
+
+#include <cassert>
+#include <string>
+#include <vector>
+
+class order {
+  using self = order;
+
+  long const& get_price() const
+  {
+    return price.value;
+  }
+  long const& set_price(long x)
+  {
+    return price.value = x;
+  }
+  int const& get_quantity() const
+  {
+    return quantity.value;
+  }
+  int const& set_quantity(int x)
+  {
+    return quantity.value = x;
+  }
+
+  struct plain {
+    std::string value;
+
+    std::string const& get(order const&) const
+    {
+      return value;
+    }
+    void set(order&, std::string x)
+    {
+      value = std::move(x);
+    }
+  };
+
+public:
+  LIBPROPERTY_PROPERTY((long), price, get_price, set_price, self);
+  LIBPROPERTY_PROPERTY((int), quantity, get_quantity, set_quantity, self);
+  LIBPROPERTY_WRAP((plain), symbol, self);
+  LIBPROPERTY_DIRTY_TRACKING(self);
+};
+
+namespace lp = libproperty;
+
+/* three properties fit in a byte */
+static_assert(sizeof(lp::dirty_bits<3>) == 1);
+static_assert(sizeof(lp::dirty_bits<9>) == 2);
+static_assert(sizeof(lp::dirty_bits<64>) == 8);
+static_assert(sizeof(lp::dirty_bits<65>) == 16);
+static_assert(lp::impl::dirty_bits_t<order>::size() == 3);
+
+/* hosts that don't track pay nothing */
+class plain_host {
+  using self = plain_host;
+
+  int const& get_x() const
+  {
+    return x.value;
+  }
+  int const& set_x(int v)
+  {
+    return x.value = v;
+  }
+
+public:
+  LIBPROPERTY_PROPERTY((int), x, get_x, set_x, self);
+};
+static_assert(sizeof(plain_host) == sizeof(int));
+
+constexpr bool dirty_bits_work()
+{
+  lp::dirty_bits<70> bits;
+  bits.set(0);
+  bits.set(69);
+  bits.set(69);
+  bool ok = bits.any() && bits.count() == 2 && bits.test(69) && !bits.test(1);
+  bits.reset(0);
+  ok = ok && bits.count() == 1;
+  bits.clear();
+  return ok && !bits.any();
+}
+static_assert(dirty_bits_work());
+
+std::vector<std::string> dirty_names(order const& o)
+{
+  std::vector<std::string> names;
+  lp::for_each_dirty(o, [&](auto const&, auto info) {
+    names.emplace_back(decltype(info)::name);
+  });
+  return names;
+}
+
+int main()
+{
+  order o;
+  assert(!lp::dirty(o).any());
+  assert(dirty_names(o).empty());
+
+  // reads don't mark
+  long p = o.price;
+  std::string s = o.symbol;
+  static_cast<void>(p);
+  assert(!lp::dirty(o).any());
+
+  // assignment
+  o.price = 10;
+  assert(lp::is_dirty(o, &order::price));
+  assert(!lp::is_dirty(o, &order::quantity));
+  assert((dirty_names(o) == std::vector<std::string>{ "price" }));
+
+  // wrappers
+  o.symbol = std::string("ACME");
+  assert(lp::is_dirty(o, &order::symbol));
+  assert((dirty_names(o) == std::vector<std::string>{ "price", "symbol" }));
+
+  lp::clear_dirty(o);
+  assert(!lp::dirty(o).any());
+
+  // compound operators and modify
+  o.quantity += 2;
+  assert(lp::is_dirty(o, &order::quantity));
+  lp::clear_dirty(o);
+  ++o.quantity;
+  assert(lp::is_dirty(o, &order::quantity));
+  lp::clear_dirty(o);
+  o.price.modify([](long& x) { x *= 2; });
+  assert(lp::is_dirty(o, &order::price));
+  assert(lp::dirty(o).count() == 1);
+
+  // the visitor sees the properties themselves
+  long sum = 0;
+  o.quantity = 4;
+  lp::for_each_dirty(o, [&](auto const& prop, auto) {
+    if constexpr (std::is_convertible_v<decltype(prop), long>) {
+      sum += prop;
+    }
+  });
+  assert(o.price == 20 && o.quantity == 4);
+  assert(sum == 24);
+
+  // copies carry the bits of the original
+  order copy = o;
+  assert(lp::dirty(copy).count() == 2);
+}
@@ -0,0 +1,113 @@
+#define LIBPROPERTY_INSTRUMENT_LATENCY
+#include "libproperty/bitfield.hpp"
+#include "libproperty/property.hpp"
+
+#include <cassert>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+class sensor {
+  using self = sensor;
+
+  int const& get_reading() const
+  {
+    return reading.value;
+  }
+  int const& set_reading(int x)
+  {
+    return reading.value = x;
+  }
+
+  struct plain {
+    std::string value;
+
+    template <typename Host>
+    std::string const& get(Host const&) const
+    {
+      return value;
+    }
+    template <typename Host>
+    void set(Host const&, std::string x)
+    {
+      value = std::move(x);
+    }
+  };
+
+public:
+  LIBPROPERTY_PROPERTY((int), reading, get_reading, set_reading, self);
+  LIBPROPERTY_WRAP((plain), label, self);
+  LIBPROPERTY_PROPERTY((int), unused, get_reading, set_reading, self);
+  LIBPROPERTY_BITFIELD((bool), armed, flags, 0, 1, self);
+  union {
+    unsigned flags = 0;
+    LIBPROPERTY_BITS(armed);
+  };
+};
+
+libproperty::property_stats stats_of(std::string_view property)
+{
+  for (auto const& stats : libproperty::instrumentation_report()) {
+    if (stats.host == typeid(sensor) && stats.property == property) {
+      return stats;
+    }
+  }
+  assert(false && "property never accessed");
+  return { typeid(void), property };
+}
+
+std::uint64_t total(libproperty::property_stats::histogram const& h)
+{
+  return std::accumulate(h.begin(), h.end(), std::uint64_t{ 0 });
+}
+
+int main()
+{
+  sensor s;
+  s.reading = 1;
+  s.reading += 2; // one write, through modify
+  int const r = s.reading;
+  assert(r == 3);
+  s.label = std::string{ "north" };
+  std::string const l = s.label;
+  assert(l == "north");
+  s.armed = true;
+  assert(s.armed);
+
+  // threads that have exited still count
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&s] {
+      for (int j = 0; j < 1000; ++j) {
+        int const seen = s.reading;
+        static_cast<void>(seen);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  auto const reading = stats_of("reading");
+  assert(reading.reads == 1 + 4 * 1000);
+  assert(reading.writes == 2);
+  assert(total(reading.read_latency) == reading.reads);
+  assert(total(reading.write_latency) == reading.writes);
+
+  auto const label = stats_of("label");
+  assert(label.reads == 1);
+  assert(label.writes == 1);
+
+  auto const armed = stats_of("armed");
+  assert(armed.reads == 1 && armed.writes == 1);
+
+  for (auto const& stats : libproperty::instrumentation_report()) {
+    assert(stats.property != "unused");
+  }
+
+  std::ostringstream out;
+  libproperty::write_instrumentation_report(out);
+  assert(out.str().find(".reading 4001 2\n") != std::string::npos);
+}
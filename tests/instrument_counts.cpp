@@ -0,0 +1,62 @@
+#define LIBPROPERTY_INSTRUMENT
+#include "libproperty/property.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+/* counts only: the shards carry no histograms */
+
+class gauge {
+  using self = gauge;
+
+  int const& get_level() const
+  {
+    return level.value;
+  }
+  int const& set_level(int x)
+  {
+    return level.value = x;
+  }
+
+public:
+  LIBPROPERTY_PROPERTY((int), level, get_level, set_level, self);
+};
+
+// the site, two links and the two counters
+static_assert(sizeof(libproperty::impl::probe_shard)
+    == 3 * sizeof(void*) + 2 * sizeof(std::uint64_t));
+
+int main()
+{
+  gauge g;
+  g.level = 1;
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&g] {
+      for (int j = 0; j < 100; ++j) {
+        int const seen = g.level;
+        static_cast<void>(seen);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  int const last = g.level;
+  assert(last == 1);
+
+  bool found = false;
+  for (auto const& stats : libproperty::instrumentation_report()) {
+    if (stats.host == typeid(gauge)) {
+      found = true;
+      assert(stats.reads == 4 * 100 + 1 && stats.writes == 1);
+      for (auto const count : stats.read_latency) {
+        assert(count == 0);
+      }
+    }
+  }
+  assert(found);
+}
@@ -0,0 +1,239 @@
+#include "libproperty/dirty.hpp"
+#include "libproperty/journal.hpp"
+#include "libproperty/property.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+class account {
+  using self = account;
+
+  int const& get_owner() const
+  {
+    return owner.value;
+  }
+  int const& set_owner(int x)
+  {
+    return owner.value = x;
+  }
+
+public:
+  explicit account(int id = 0)
+      : number(id)
+  {
+  }
+  int id() const
+  {
+    return number;
+  }
+
+  int number;
+
+  LIBPROPERTY_PROPERTY((int), owner, get_owner, set_owner, self);
+  LIBPROPERTY_JOURNALED((long), balance, self);
+  LIBPROPERTY_JOURNALED((double), rate, self);
+  LIBPROPERTY_JOURNAL_ID(id, self);
+};
+
+/* ids default to the host's address */
+struct anonymous {
+  LIBPROPERTY_JOURNALED((int), x, anonymous);
+};
+
+/* replay marks what it restores dirty */
+struct tracked {
+  LIBPROPERTY_JOURNALED((int), x, tracked);
+  LIBPROPERTY_JOURNALED((int), y, tracked);
+  LIBPROPERTY_DIRTY_TRACKING(tracked);
+};
+
+static_assert(sizeof(libproperty::journaled<long, void>) == sizeof(long));
+
+namespace lp = libproperty;
+
+constexpr std::size_t record_size(std::size_t value_size)
+{
+  return sizeof(lp::journal_record) + value_size;
+}
+
+long file_size(char const* path)
+{
+  auto* f = std::fopen(path, "rb");
+  assert(f);
+  std::fseek(f, 0, SEEK_END);
+  long const size = std::ftell(f);
+  std::fclose(f);
+  return size;
+}
+
+int main()
+{
+  char const* const path = "journal-test.log";
+  std::remove(path);
+
+  constexpr int threads = 4;
+  constexpr int writes = 10000;
+  std::vector<account> accounts;
+  for (int i = 0; i < threads; ++i) {
+    accounts.emplace_back(i);
+  }
+
+  // without a journal, nothing is recorded
+  accounts[0].balance = -1;
+  assert(lp::journal::current() == nullptr);
+
+  {
+    // small blocks and a long interval: most records go out in full blocks
+    lp::journal log(path, std::chrono::milliseconds(1000), 4096);
+    assert(lp::journal::current() == &log);
+
+    bool threw = false;
+    try {
+      lp::journal second(path);
+    } catch (std::logic_error const&) {
+      threw = true;
+    }
+    assert(threw && lp::journal::current() == &log);
+
+    std::vector<std::thread> writers;
+    for (int t = 0; t < threads; ++t) {
+      writers.emplace_back([&accounts, t] {
+        auto& a = accounts[t];
+        for (int i = 1; i <= writes; ++i) {
+          a.balance = i * (t + 1);
+        }
+        a.rate = 0.5 * t;
+        a.balance.modify([](long& b) { b += 1; });
+        a.owner = 7; // not journaled
+      });
+    }
+    for (auto& w : writers) {
+      w.join();
+    }
+
+    // this thread's records go out on flush; the writers' went at exit
+    accounts[0].rate += 1.0;
+    log.flush();
+    assert(file_size(path)
+        == threads * ((writes + 1) * record_size(sizeof(long))
+                         + record_size(sizeof(double)))
+            + record_size(sizeof(double)));
+
+    anonymous a;
+    a.x = 3;
+  } // writes out the rest
+
+  // replay into fresh hosts
+  std::vector<account> restored;
+  for (int i = 0; i < threads; ++i) {
+    restored.emplace_back(i);
+    restored.back().owner = 0;
+  }
+  auto const applied = lp::replay(path, [&](std::uint64_t id) {
+    return id < restored.size() ? &restored[id] : nullptr;
+  });
+  assert(applied == threads * (writes + 2) + 1);
+  for (int t = 0; t < threads; ++t) {
+    assert(restored[t].balance == writes * (t + 1) + 1);
+    assert(restored[t].rate == accounts[t].rate);
+    assert(restored[t].owner == 0);
+  }
+  assert(restored[0].rate == 1.0);
+
+  // replaying does not record
+  {
+    lp::journal log("journal-test-2.log");
+    lp::replay(path, [&](std::uint64_t id) {
+      return id < restored.size() ? &restored[id] : nullptr;
+    });
+    log.flush();
+    assert(file_size("journal-test-2.log") == 0);
+  }
+
+  // a record cut short by a crash ends the replay
+  {
+    auto* f = std::fopen(path, "ab");
+    lp::journal_record const torn{ 0, 1, sizeof(long) };
+    std::fwrite(&torn, sizeof(torn), 1, f);
+    std::fwrite("abc", 1, 3, f);
+    std::fclose(f);
+  }
+  assert(lp::replay(path, [&](std::uint64_t id) {
+    return id < restored.size() ? &restored[id] : nullptr;
+  }) == applied);
+
+  // so does a size that runs past the end of the file
+  {
+    std::remove(path);
+    {
+      lp::journal log(path);
+      account a(0);
+      a.balance = 5;
+      log.close();
+      assert(lp::journal::current() == nullptr);
+      a.balance = 6; // not recorded
+    }
+    auto* f = std::fopen(path, "ab");
+    lp::journal_record const bogus{ 0, 1, 0xffffffffu };
+    std::fwrite(&bogus, sizeof(bogus), 1, f);
+    std::fwrite("abcdefgh", 1, 8, f);
+    std::fclose(f);
+    assert(file_size(path) == 2 * record_size(sizeof(long)));
+    std::vector<account> fresh(1);
+    assert(lp::replay(path, [&](std::uint64_t id) {
+      return id < fresh.size() ? &fresh[id] : nullptr;
+    }) == 1);
+    assert(fresh[0].balance == 5);
+  }
+
+  // replayed properties are dirty
+  {
+    std::remove(path);
+    tracked t;
+    {
+      lp::journal log(path);
+      t.y = 3;
+    }
+    tracked fresh;
+    lp::replay(path, [&](std::uint64_t) { return &fresh; });
+    assert(fresh.y == 3);
+    assert(lp::is_dirty(fresh, &tracked::y));
+    assert(!lp::is_dirty(fresh, &tracked::x));
+  }
+
+  // a failed write is reported, and stops further appends
+  if (auto* full = std::fopen("/dev/full", "ab")) {
+    std::fclose(full);
+    lp::journal log("/dev/full");
+    account a(0);
+    a.balance = 1;
+    bool threw = false;
+    try {
+      log.flush();
+    } catch (std::system_error const&) {
+      threw = true;
+    }
+    assert(threw && log.error());
+    threw = false;
+    try {
+      a.balance = 2;
+    } catch (std::system_error const&) {
+      threw = true;
+    }
+    assert(threw);
+    threw = false;
+    try {
+      log.close();
+    } catch (std::system_error const&) {
+      threw = true;
+    }
+    assert(threw && lp::journal::current() == nullptr);
+  }
+
+  std::remove(path);
+  std::remove("journal-test-2.log");
+}
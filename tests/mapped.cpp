@@ -0,0 +1,96 @@
+#include "libproperty/mapped.hpp"
+#include "libproperty/property.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <new>
+
+class node {
+  using self = node;
+
+  long const& get_key() const
+  {
+    return key.value;
+  }
+  long const& set_key(long x)
+  {
+    return key.value = x;
+  }
+  libproperty::offset_ptr<node> const& get_next() const
+  {
+    return next.value;
+  }
+  libproperty::offset_ptr<node> const& set_next(node* x)
+  {
+    return next.value = x;
+  }
+
+public:
+  LIBPROPERTY_PROPERTY((long), key, get_key, set_key, self);
+  LIBPROPERTY_PROPERTY(
+      (libproperty::offset_ptr<node>), next, get_next, set_next, self);
+};
+
+/* stands in for a mapped file */
+struct region {
+  static constexpr std::size_t size = 4096;
+  alignas(std::max_align_t) char bytes[size];
+};
+
+int main()
+{
+  auto const before = std::make_unique<region>();
+  {
+    auto arena = libproperty::mapped_arena::create(before->bytes, region::size);
+    node* head = nullptr;
+    for (long i = 0; i < 10; ++i) {
+      node* n = arena.make<node>();
+      n->key = i;
+      n->next = head;
+      head = n;
+    }
+    arena.set_root(head);
+    assert(arena.used() > 10 * sizeof(node));
+  }
+
+  // "restart": the same bytes, at another address
+  auto const after = std::make_unique<region>();
+  std::memcpy(after->bytes, before->bytes, region::size);
+  std::memset(before->bytes, 0, region::size);
+
+  auto arena = libproperty::mapped_arena::open(after->bytes, region::size);
+  long expected = 9;
+  for (node* n = arena.root<node>(); n;) {
+    long const key = n->key;
+    assert(key == expected--);
+    assert(reinterpret_cast<char*>(n) >= after->bytes
+        && reinterpret_cast<char*>(n) < after->bytes + region::size);
+    libproperty::offset_ptr<node> const& next = n->next;
+    n = next.get();
+  }
+  assert(expected == -1);
+
+  // keeps allocating where it left off
+  std::size_t const used = arena.used();
+  arena.make<node>();
+  assert(arena.used() == used + sizeof(node));
+
+  bool full = false;
+  try {
+    for (;;) {
+      arena.make<node>();
+    }
+  } catch (std::bad_alloc const&) {
+    full = true;
+  }
+  assert(full);
+
+  bool refused = false;
+  try {
+    libproperty::mapped_arena::open(before->bytes, region::size);
+  } catch (libproperty::arena_error const&) {
+    refused = true;
+  }
+  assert(refused);
+}
@@ -0,0 +1,145 @@
+#include "libproperty/property.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <string>
+
+/* dependencies are rw_properties */
+class vec {
+  using self = vec;
+
+  double const& get_x() const
+  {
+    return x.value;
+  }
+  double const& set_x(double v)
+  {
+    return x.value = v;
+  }
+  double const& get_y() const
+  {
+    return y.value;
+  }
+  double const& set_y(double v)
+  {
+    return y.value = v;
+  }
+  double compute_length() const
+  {
+    ++computations;
+    return std::sqrt(x.value * x.value + y.value * y.value);
+  }
+
+public:
+  mutable int computations = 0;
+
+  LIBPROPERTY_PROPERTY((double), x, get_x, set_x, self);
+  LIBPROPERTY_PROPERTY((double), y, get_y, set_y, self);
+  LIBPROPERTY_MEMOIZED((double), length, compute_length, self);
+  LIBPROPERTY_INVALIDATES(x, self, &self::length);
+  LIBPROPERTY_INVALIDATES(y, self, &self::length);
+};
+static_assert(sizeof(vec::length) == sizeof(std::optional<double>),
+    "A memoized property is supposed to be exactly its cache!");
+
+/* a dependency shared by two memoized properties, and one that is a wrapper */
+class label {
+  struct plain {
+    std::string value;
+
+    std::string const& get(label const&) const
+    {
+      return value;
+    }
+    void set(label&, std::string x)
+    {
+      value = std::move(x);
+    }
+  };
+
+  // these read other properties, so they are defined below the class
+  std::string compute_text() const;
+  std::size_t compute_size() const;
+
+public:
+  mutable int computations = 0;
+
+  LIBPROPERTY_WRAP((plain), name, label);
+  LIBPROPERTY_MEMOIZED((std::string), text, compute_text, label);
+  LIBPROPERTY_MEMOIZED((std::size_t), size, compute_size, label);
+  LIBPROPERTY_INVALIDATES(name, label, &label::text, &label::size);
+
+  // not a property: invalidates by hand
+  void set_count(int c)
+  {
+    count.value = c;
+    text.invalidate();
+    size.invalidate();
+  }
+
+  // not a property either, but public like the rest to keep `label`
+  // standard-layout
+  struct {
+    int value = 0;
+  } count;
+};
+
+std::string label::compute_text() const
+{
+  ++computations;
+  std::string const& n = name;
+  return n + std::to_string(count.value);
+}
+std::size_t label::compute_size() const
+{
+  std::string const& t = text; // memoized properties can depend on each other
+  return t.size();
+}
+
+int main()
+{
+  {
+    vec v;
+    v.x = 3.0;
+    v.y = 4.0;
+    assert(!v.length.is_cached());
+    assert(v.length == 5.0);
+    assert(v.length == 5.0);
+    assert(v.computations == 1);
+
+    v.x = 0.0;
+    assert(!v.length.is_cached());
+    assert(v.length == 4.0);
+    assert(v.computations == 2);
+
+    v.y *= 2; // compound assignment invalidates as well
+    assert(v.length == 8.0);
+    v.y.modify([](double& y) { y = 6.0; });
+    assert(v.length == 6.0);
+    assert(v.computations == 4);
+
+    // copies carry their cache along
+    vec w = v;
+    assert(w.length.is_cached());
+    assert(w.length == 6.0);
+    assert(w.computations == 4);
+  }
+  {
+    label l;
+    l.name = std::string{ "item" };
+    std::string const& text = l.text;
+    assert(text == "item0");
+    assert(l.size == 5);
+    assert(l.computations == 1);
+
+    l.set_count(42);
+    assert(l.size == 6);
+    assert(l.computations == 2);
+
+    l.name += "s";
+    assert(!l.text.is_cached() && !l.size.is_cached());
+    std::string const& renamed = l.text;
+    assert(renamed == "items42");
+    assert(l.computations == 3);
+  }
+}
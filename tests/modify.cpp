@@ -0,0 +1,167 @@
+#include "libproperty/property.hpp"
+
+#include <cassert>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* rw_property without a hook: get, modify a copy, set */
+struct counted {
+  int gets = 0;
+  int sets = 0;
+
+  int const& get_value() const
+  {
+    ++const_cast<counted*>(this)->gets;
+    return value.value;
+  }
+  int const& set_value(int x)
+  {
+    ++sets;
+    return value.value = x;
+  }
+
+  LIBPROPERTY_PROPERTY((int), value, get_value, set_value, counted);
+};
+
+/* rw_property with a host-side hook: no copies of the vector */
+class journal {
+  using self = journal;
+
+  std::vector<std::string> const& get_lines() const
+  {
+    return lines.value;
+  }
+  std::vector<std::string> const& set_lines(std::vector<std::string> x)
+  {
+    ++sets;
+    return lines.value = std::move(x);
+  }
+  template <typename F>
+  decltype(auto) modify_lines(F&& f)
+  {
+    ++modifications;
+    return std::forward<F>(f)(lines.value);
+  }
+
+public:
+  int sets = 0;
+  int modifications = 0;
+
+  LIBPROPERTY_PROPERTY(
+      (std::vector<std::string>), lines, get_lines, set_lines, self);
+  LIBPROPERTY_MODIFIER(lines, modify_lines, self);
+};
+
+/* wrapper with policy-side modify and compound hooks */
+class tally {
+  struct plain {
+    std::string value;
+
+    std::string const& get(tally const&) const
+    {
+      return value;
+    }
+    void set(tally& host, std::string x)
+    {
+      ++host.sets;
+      value = std::move(x);
+    }
+  };
+
+  struct hooked {
+    long value;
+
+    long get(tally const&) const
+    {
+      return value;
+    }
+    void set(tally& host, long x)
+    {
+      ++host.sets;
+      value = x;
+    }
+    template <typename F>
+    decltype(auto) modify(tally& host, F&& f)
+    {
+      ++host.modifications;
+      return std::forward<F>(f)(value);
+    }
+    long compound(tally& host, libproperty::ops::plus_assign, long x)
+    {
+      ++host.compounds;
+      return value += x;
+    }
+  };
+
+public:
+  int sets = 0;
+  int modifications = 0;
+  int compounds = 0;
+
+  LIBPROPERTY_WRAP((plain), text, tally);
+  LIBPROPERTY_WRAP((hooked), total, tally);
+};
+
+int main()
+{
+  {
+    counted x;
+    x.value = 1;
+    x.value += 2;
+    assert(x.value == 3);
+    x.value *= 5;
+    x.value -= 1;
+    x.value |= 16;
+    assert(x.value == 30);
+    assert((++x.value) == 31);
+    assert(x.value++ == 31);
+    assert(x.value == 32);
+    assert(x.value-- == 32);
+    assert((--x.value) == 30);
+    // every operation went through the getter and setter
+    int const sets = x.sets;
+    int const gets = x.gets;
+    x.value <<= 1;
+    assert(x.sets == sets + 1);
+    assert(x.gets == gets + 1);
+    // modify returns what the function returns
+    assert(x.value.modify([](int& v) { return v /= 6; }) == 10);
+    assert(x.value == 10);
+  }
+  {
+    journal j;
+    j.lines = std::vector<std::string>{ "a" };
+    assert(j.sets == 1);
+    auto const size = j.lines.modify([](auto& lines) {
+      lines.push_back("b");
+      return lines.size();
+    });
+    assert(size == 2);
+    // went through the hook, not the setter
+    assert(j.sets == 1);
+    assert(j.modifications == 1);
+    std::vector<std::string> const& lines = j.lines;
+    assert(lines.size() == 2 && lines[1] == "b");
+  }
+  {
+    tally t;
+    t.text = std::string{ "foo" };
+    t.text += "bar";
+    std::string const& text = t.text;
+    assert(text == "foobar");
+    assert(t.sets == 2);
+
+    t.total = 5l;
+    t.total += 2l; // compound hook
+    assert(t.total == 7);
+    assert(t.compounds == 1);
+    t.total *= 3l; // no compound hook for this one: modify hook
+    assert(t.total == 21);
+    assert(t.modifications == 1);
+    assert(t.total++ == 21);
+    assert(t.total == 22);
+    assert(t.modifications == 2);
+    assert(t.sets == 3); // just the assignments
+  }
+}
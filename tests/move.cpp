@@ -1,5 +1,6 @@
 #include "libproperty/property.hpp"
 
+#include <cassert>
 #include <memory>
 #include <string>
 #include <utility>
@@ -21,9 +22,23 @@ class X {
     return (str.value) ? *str.value : empty;
   }
 
+  std::string take_str() &&
+  {
+    return (str.value) ? std::move(*str.value) : std::string{};
+  }
+
 public:
-  LIBPROPERTY_PROPERTY(
-      (std::unique_ptr<std::string>), str, get_str, set_str, X);
+  LIBPROPERTY_MOVABLE_PROPERTY((std::unique_ptr<std::string>),
+      str,
+      get_str,
+      take_str,
+      set_str,
+      X);
+
+  char const* data() const
+  {
+    return str.value->data();
+  }
 };
 
 int main()
@@ -37,6 +52,24 @@ int main()
     x.str = "foo";
     auto y = std::move(x);
   }
+  {
+    // reading from an expiring host moves the string out
+    X x;
+    x.str = std::string(100, 'x');
+    auto const* buffer = x.data();
+    std::string const copied = x.str;
+    assert(copied.data() != buffer);
+    std::string const moved = std::move(x).str;
+    assert(moved.data() == buffer);
+    assert(moved == copied);
+  }
+  {
+    X x;
+    x.str = std::string(100, 'y');
+    auto const* buffer = x.data();
+    std::string const moved = libproperty::get(std::move(x), &X::str);
+    assert(moved.data() == buffer);
+  }
   {
 #ifdef ENSURE_DOES_NOT_COMPILE_1
     X x;
@@ -0,0 +1,155 @@
+#include "libproperty/property.hpp"
+
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ * noexcept and SFINAE conformance: properties are as noexcept as the accessors
+ * behind them, and their operators only exist where they apply. Everything
+ * here is checked at compile time.
+ */
+
+class host {
+  using self = host;
+
+  int const& get_fast() const noexcept
+  {
+    return fast.value;
+  }
+  int const& set_fast(int x) noexcept
+  {
+    return fast.value = x;
+  }
+
+  std::string const& get_slow() const
+  {
+    return slow.value;
+  }
+  std::string const& set_slow(std::string x)
+  {
+    return slow.value = std::move(x);
+  }
+
+  std::vector<int> const& get_list() const noexcept
+  {
+    return list.value;
+  }
+  void set_list(std::vector<int> x)
+  {
+    list.value = std::move(x);
+  }
+
+  template <typename T, bool Noexcept>
+  struct policy {
+    T value;
+
+    template <typename Host>
+    T const& get(Host const&) const noexcept(Noexcept)
+    {
+      return value;
+    }
+    template <typename Host>
+    void set(Host const&, T const& x) noexcept(Noexcept)
+    {
+      value = x;
+    }
+  };
+
+public:
+  LIBPROPERTY_PROPERTY((int), fast, get_fast, set_fast, self);
+  LIBPROPERTY_PROPERTY((std::string), slow, get_slow, set_slow, self);
+  LIBPROPERTY_PROPERTY((std::vector<int>), list, get_list, set_list, self);
+  LIBPROPERTY_WRAP((policy<int, true>), wrapped_fast, self);
+  LIBPROPERTY_WRAP((policy<std::string, false>), wrapped_slow, self);
+};
+
+template <typename P, typename X>
+using plus_assign_t = decltype(std::declval<P>() += std::declval<X>());
+template <typename P, typename X>
+using minus_assign_t = decltype(std::declval<P>() -= std::declval<X>());
+template <typename P>
+using increment_t = decltype(++std::declval<P>());
+template <typename P>
+using post_increment_t = decltype(std::declval<P>()++);
+template <typename P, typename X>
+using less_t = decltype(std::declval<P>() < std::declval<X>());
+template <typename X, typename P>
+using less_reversed_t = decltype(std::declval<X>() < std::declval<P>());
+template <typename P, typename X>
+using plus_t = decltype(std::declval<P>() + std::declval<X>());
+
+using fast_t = decltype((std::declval<host&>().fast));
+using slow_t = decltype((std::declval<host&>().slow));
+using list_t = decltype((std::declval<host&>().list));
+using wrapped_fast_t = decltype((std::declval<host&>().wrapped_fast));
+using wrapped_slow_t = decltype((std::declval<host&>().wrapped_slow));
+template <template <typename...> class Op, typename... Args>
+constexpr bool ok = libproperty::meta::is_detected_v<Op, Args...>;
+
+// std::is_nothrow_convertible is C++20
+template <typename To>
+void take(To) noexcept;
+template <typename From, typename To>
+constexpr bool nothrow_converts = noexcept(take<To>(std::declval<From>()));
+
+/* reads are as noexcept as the getter */
+static_assert(nothrow_converts<fast_t, int>);
+static_assert(!nothrow_converts<slow_t, std::string>);
+static_assert(nothrow_converts<list_t, std::vector<int> const&>);
+static_assert(noexcept(int(std::move(std::declval<host&>()).fast)));
+static_assert(nothrow_converts<wrapped_fast_t, int const&>);
+static_assert(!nothrow_converts<wrapped_slow_t, std::string>);
+
+/* writes are as noexcept as the setter, and need one that accepts the value */
+static_assert(std::is_nothrow_assignable_v<fast_t, int>);
+static_assert(std::is_assignable_v<slow_t, char const*>);
+static_assert(!std::is_nothrow_assignable_v<slow_t, std::string>);
+static_assert(!std::is_assignable_v<fast_t, std::string>);
+static_assert(!std::is_assignable_v<slow_t, std::vector<int>>);
+static_assert(!std::is_nothrow_assignable_v<list_t, std::vector<int>>);
+static_assert(std::is_nothrow_assignable_v<wrapped_fast_t, int>);
+static_assert(!std::is_assignable_v<wrapped_fast_t, std::string>);
+static_assert(!std::is_nothrow_assignable_v<wrapped_slow_t, std::string>);
+static_assert(!std::is_assignable_v<wrapped_slow_t, std::vector<int>>);
+
+/* compound operators only exist where the value supports them */
+static_assert(ok<plus_assign_t, fast_t, int>);
+static_assert(ok<minus_assign_t, fast_t, int>);
+static_assert(ok<increment_t, fast_t>);
+static_assert(ok<post_increment_t, fast_t>);
+static_assert(ok<plus_assign_t, slow_t, char const*>);
+static_assert(!ok<minus_assign_t, slow_t, int>);
+static_assert(!ok<increment_t, slow_t>);
+static_assert(!ok<plus_assign_t, list_t, int>);
+static_assert(ok<plus_assign_t, wrapped_fast_t, int>);
+static_assert(!ok<increment_t, wrapped_slow_t>);
+static_assert(!ok<plus_assign_t, wrapped_slow_t, std::vector<int>>);
+
+/* so do a wrapper's binary operators, and they are noexcept when get is */
+static_assert(ok<less_t, wrapped_fast_t, int>);
+static_assert(ok<less_reversed_t, int, wrapped_fast_t>);
+static_assert(ok<less_t, wrapped_fast_t, wrapped_fast_t>);
+static_assert(ok<plus_t, wrapped_slow_t, char const*>);
+static_assert(!ok<less_t, wrapped_fast_t, std::string>);
+static_assert(!ok<plus_t, wrapped_slow_t, int>);
+static_assert(noexcept(std::declval<host&>().wrapped_fast < 1));
+static_assert(noexcept(std::declval<host&>().wrapped_fast
+    == std::declval<host&>().wrapped_fast));
+static_assert(!noexcept(std::declval<host&>().wrapped_slow == "x"));
+
+/* hosts keep the noexcept-ness of their members' special members */
+static_assert(std::is_nothrow_move_constructible_v<host>);
+static_assert(std::is_nothrow_move_assignable_v<host>);
+static_assert(!std::is_nothrow_copy_constructible_v<host>);
+
+int main()
+{
+  host h;
+  h.fast = 1;
+  h.fast += 2;
+  h.slow = "abc";
+  h.wrapped_fast = 3;
+  return (h.fast == 3 && h.wrapped_fast < 4) ? 0 : 1;
+}
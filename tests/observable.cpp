@@ -0,0 +1,150 @@
+#include "libproperty/observable.hpp"
+#include "libproperty/property.hpp"
+
+#include <cassert>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct model {
+  LIBPROPERTY_OBSERVABLE((int), count, model);
+  LIBPROPERTY_OBSERVABLE((std::string), title, model);
+};
+
+/* properties that aren't observable don't pay for it */
+class plain {
+  using self = plain;
+
+  int const& get_x() const
+  {
+    return x.value;
+  }
+  int const& set_x(int v)
+  {
+    return x.value = v;
+  }
+
+public:
+  LIBPROPERTY_PROPERTY((int), x, get_x, set_x, self);
+};
+static_assert(sizeof(plain) == sizeof(int));
+static_assert(sizeof(libproperty::observable<long>)
+    == sizeof(long) + 4 * sizeof(void*));
+
+int main()
+{
+  {
+    // notified after every write, with the new value
+    model m;
+    std::vector<int> seen;
+    auto o = libproperty::make_observer<int>([&](int x) { seen.push_back(x); });
+    libproperty::subscribe(m.count, o);
+    m.count = 1;
+    m.count += 2;
+    ++m.count;
+    assert((seen == std::vector<int>{ 1, 3, 4 }));
+
+    o.unsubscribe();
+    m.count = 5;
+    assert(seen.size() == 3);
+  }
+  {
+    // a batch coalesces writes into one notification per property
+    model m;
+    std::vector<int> counts;
+    std::vector<std::string> titles;
+    auto c = libproperty::make_observer<int>(
+        [&](int x) { counts.push_back(x); });
+    auto t = libproperty::make_observer<std::string>(
+        [&](std::string const& x) { titles.push_back(x); });
+    libproperty::subscribe(m.count, c);
+    libproperty::subscribe(m.title, t);
+    {
+      libproperty::batch frame;
+      for (int i = 0; i < 100; ++i) {
+        m.count = i;
+      }
+      m.title = std::string{ "a" };
+      {
+        libproperty::batch nested; // the outer one delivers
+        m.title = std::string{ "b" };
+      }
+      assert(counts.empty() && titles.empty());
+
+      // flushing a nested batch delivers what the outermost one holds
+      {
+        libproperty::batch nested;
+        m.count = 100;
+        nested.flush();
+        assert((counts == std::vector<int>{ 100 }));
+        assert((titles == std::vector<std::string>{ "b" }));
+      }
+      m.count = 101;
+    }
+    assert((counts == std::vector<int>{ 100, 101 }));
+    assert((titles == std::vector<std::string>{ "b" }));
+  }
+  {
+    // observers that write are delivered in the same round
+    model m;
+    std::vector<std::string> titles;
+    auto c = libproperty::make_observer<int>(
+        [&](int x) { m.title = std::to_string(x); });
+    auto t = libproperty::make_observer<std::string>(
+        [&](std::string const& x) { titles.push_back(x); });
+    libproperty::subscribe(m.count, c);
+    libproperty::subscribe(m.title, t);
+    {
+      libproperty::batch frame;
+      m.count = 7;
+      m.count = 8;
+    }
+    assert((titles == std::vector<std::string>{ "8" }));
+  }
+  {
+    // lifetimes: either side can go first, observers can leave mid-call
+    auto m = std::make_unique<model>();
+    int calls = 0;
+    {
+      auto o = libproperty::make_observer<int>([&](int) { ++calls; });
+      libproperty::subscribe(m->count, o);
+      m->count = 1;
+    }
+    m->count = 2;
+    assert(calls == 1);
+
+    auto o = libproperty::make_observer<int>([&](int) { ++calls; });
+    libproperty::subscribe(m->count, o);
+    {
+      libproperty::batch frame;
+      m->count = 3;
+      m.reset(); // pending, and then gone
+    }
+    assert(calls == 1);
+    assert(!o.subscribed());
+
+    model n;
+    libproperty::basic_observer<int>* self = nullptr;
+    auto once = libproperty::make_observer<int>([&](int) {
+      ++calls;
+      self->unsubscribe();
+    });
+    self = &once;
+    auto every = libproperty::make_observer<int>([&](int) { ++calls; });
+    libproperty::subscribe(n.count, every);
+    libproperty::subscribe(n.count, once);
+    n.count = 1;
+    n.count = 2;
+    assert(calls == 1 + 1 + 2);
+  }
+  {
+    // copies don't take the observers along
+    model m;
+    int calls = 0;
+    auto o = libproperty::make_observer<int>([&](int) { ++calls; });
+    libproperty::subscribe(m.count, o);
+    model copy = m;
+    copy.count = 1;
+    assert(calls == 0);
+  }
+}
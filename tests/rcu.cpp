@@ -0,0 +1,122 @@
+#include "libproperty/rcu.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using table = std::map<int, std::string>;
+
+struct router {
+  LIBPROPERTY_RCU((table), routes, router);
+};
+
+/* the cache lines of the readers are out of line: hosts hold a pointer */
+static_assert(sizeof(router) == sizeof(void*));
+static_assert(alignof(router) == alignof(void*));
+
+/* every table the writer publishes maps 0..size-1 to the same name */
+bool consistent(table const& t)
+{
+  for (auto const& [k, v] : t) {
+    if (v != t.begin()->second) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main()
+{
+  {
+    router r;
+    std::shared_ptr<table const> empty = r.routes;
+    assert(empty->empty());
+
+    r.routes = table{ { 1, "a" }, { 2, "b" } };
+    std::shared_ptr<table const> first = r.routes;
+    assert(first->size() == 2);
+    assert(empty->empty()); // snapshots never change
+
+    table copy = r.routes; // convert_to
+    assert(copy == *first);
+
+    r.routes.modify([](table& t) { t[3] = "c"; });
+    assert(first->size() == 2);
+    auto const size = libproperty::read(
+        r.routes, [](table const& t) { return t.size(); });
+    assert(size == 3);
+
+    {
+      auto const borrowed = libproperty::borrow(r.routes);
+      assert(borrowed->size() == 3 && (*borrowed).at(3) == "c");
+    }
+
+    {
+      // a borrow pins the value it started with: the writer waits for it
+      auto borrowed = libproperty::borrow(r.routes);
+      std::atomic<bool> stored{ false };
+      std::thread writer{ [&] {
+        r.routes = table{};
+        stored = true;
+      } };
+      while (libproperty::read(r.routes, [](table const& t) {
+        return !t.empty();
+      })) {
+        std::this_thread::yield();
+      }
+      assert(borrowed->size() == 3);
+      auto moved = std::move(borrowed); // and so does the borrow it became
+      assert(moved->size() == 3 && !stored);
+      {
+        auto const gone = std::move(moved);
+      }
+      writer.join();
+      assert(stored);
+    }
+
+    // publishing an existing snapshot does not copy it
+    r.routes = first;
+    std::shared_ptr<table const> again = r.routes;
+    assert(again == first);
+
+    router other = r;
+    std::shared_ptr<table const> shared = other.routes;
+    assert(shared == first);
+  }
+  {
+    // readers see whole tables while a writer keeps replacing them
+    router r;
+    std::atomic<bool> done{ false };
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+      readers.emplace_back([&] {
+        while (!done.load()) {
+          std::shared_ptr<table const> t = r.routes;
+          assert(consistent(*t));
+          bool const ok = libproperty::read(r.routes, consistent);
+          assert(ok);
+          static_cast<void>(ok);
+          assert(consistent(*libproperty::borrow(r.routes)));
+        }
+      });
+    }
+    for (int i = 0; i < 1000; ++i) {
+      table t;
+      for (int k = 0; k < 16; ++k) {
+        t[k] = std::to_string(i);
+      }
+      r.routes = std::move(t);
+    }
+    done = true;
+    for (auto& t : readers) {
+      t.join();
+    }
+    auto const last
+        = libproperty::read(r.routes, [](table const& t) { return t.at(0); });
+    assert(last == "999");
+  }
+}
@@ -0,0 +1,127 @@
+#include "libproperty/property.hpp"
+#include "libproperty/reflection.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+class order {
+  using self = order;
+
+  long const& get_price() const
+  {
+    return price.value;
+  }
+  long const& set_price(long x)
+  {
+    return price.value = x;
+  }
+  int const& get_quantity() const
+  {
+    return quantity.value;
+  }
+  int const& set_quantity(int x)
+  {
+    return quantity.value = x;
+  }
+  long compute_total() const;
+
+  struct plain {
+    std::string value;
+
+    std::string const& get(order const&) const
+    {
+      return value;
+    }
+    void set(order&, std::string x)
+    {
+      value = std::move(x);
+    }
+  };
+
+public:
+  LIBPROPERTY_PROPERTY((long), price, get_price, set_price, self);
+  LIBPROPERTY_PROPERTY((int), quantity, get_quantity, set_quantity, self);
+  LIBPROPERTY_WRAP((plain), symbol, self);
+  LIBPROPERTY_MEMOIZED((long), total, compute_total, self);
+};
+long order::compute_total() const
+{
+  return price * quantity;
+}
+
+namespace lp = libproperty;
+
+static_assert(lp::property_count<order> == 4);
+
+using price_info = lp::property_info<order::_libproperty__price_prop_tag>;
+static_assert(price_info::name == "price");
+static_assert(price_info::offset == 0);
+static_assert(price_info::kind == lp::property_kind::rw_property);
+static_assert(std::is_same_v<price_info::value_type, long>);
+static_assert(price_info::member == &order::price);
+
+using symbol_info = lp::property_info<order::_libproperty__symbol_prop_tag>;
+static_assert(symbol_info::name == "symbol");
+static_assert(symbol_info::kind == lp::property_kind::wrapper);
+static_assert(symbol_info::offset == offsetof(order, symbol));
+
+constexpr std::size_t total_size()
+{
+  std::size_t size = 0;
+  lp::for_each_property<order>([&](auto info) {
+    size += sizeof(typename decltype(info)::property_type);
+  });
+  return size;
+}
+static_assert(total_size() <= sizeof(order));
+
+/* a generated visitor: hashes every rw_property of any host */
+template <typename Host>
+std::size_t hash_values(Host const& host)
+{
+  std::size_t seed = 0;
+  lp::for_each_property(host, [&](auto const& property, auto info) {
+    using info_t = decltype(info);
+    if constexpr (info_t::kind == lp::property_kind::rw_property) {
+      typename info_t::value_type const& value = property;
+      seed = seed * 31 + std::hash<typename info_t::value_type>{}(value);
+    }
+  });
+  return seed;
+}
+
+int main()
+{
+  order o;
+  o.price = 100l;
+  o.quantity = 3;
+  o.symbol = std::string{ "ACME" };
+
+  std::vector<std::string> names;
+  lp::for_each_property<order>(
+      [&](auto info) { names.emplace_back(info.name); });
+  assert((names
+      == std::vector<std::string>{ "price", "quantity", "symbol", "total" }));
+
+  // visiting the properties of an object goes through their accessors
+  long const total = o.total;
+  assert(total == 300);
+  std::size_t const before = hash_values(o);
+  o.quantity = 4;
+  assert(hash_values(o) != before);
+  o.quantity = 3;
+  assert(hash_values(o) == before);
+
+  // and can write to them
+  lp::for_each_property(o, [](auto& property, auto info) {
+    if constexpr (std::is_same_v<typename decltype(info)::value_type, int>) {
+      property = 10;
+    }
+  });
+  int const quantity = o.quantity;
+  assert(quantity == 10);
+}
@@ -0,0 +1,233 @@
+#include "libproperty/bitfield.hpp"
+#include "libproperty/property.hpp"
+#include "libproperty/relocate.hpp"
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+
+template <typename T>
+class rw_host {
+  using self = rw_host;
+
+  T const& get_value() const
+  {
+    return value.value;
+  }
+  T const& set_value(T x)
+  {
+    return value.value = std::move(x);
+  }
+
+public:
+  int before = 0;
+  LIBPROPERTY_PROPERTY((T), value, get_value, set_value, self);
+};
+
+template <typename T>
+struct plain {
+  T value;
+
+  template <typename Host>
+  T const& get(Host const&) const
+  {
+    return value;
+  }
+  template <typename Host>
+  void set(Host const&, T x)
+  {
+    value = std::move(x);
+  }
+};
+
+template <typename T>
+struct wrapper_host {
+  int before = 0;
+  LIBPROPERTY_WRAP((plain<T>), value, wrapper_host);
+};
+
+template <typename T>
+class memoized_host {
+  using self = memoized_host;
+
+  T compute() const
+  {
+    return T{};
+  }
+
+public:
+  LIBPROPERTY_MEMOIZED((T), value, compute, self);
+};
+
+struct point {
+  double x, y;
+};
+
+struct bits_host {
+  LIBPROPERTY_BITFIELD((unsigned), low, word, 0, 16, bits_host);
+  LIBPROPERTY_BITFIELD((unsigned), high, word, 16, 16, bits_host);
+  union {
+    std::uint32_t word = 0;
+    LIBPROPERTY_BITS(low);
+    LIBPROPERTY_BITS(high);
+  };
+};
+
+class facade {
+  using self = facade;
+
+  int get_answer() const
+  {
+    return 42;
+  }
+  int set_answer(int x)
+  {
+    return x;
+  }
+
+public:
+  LIBPROPERTY_EMPTY_PROPERTY(answer, get_answer, set_answer, self);
+};
+
+/* the matrix: a host is trivially X exactly when what it stores is */
+template <typename Host, typename Value>
+constexpr bool mirrors
+    = std::is_trivially_copyable_v<Host> == std::is_trivially_copyable_v<Value>
+    && std::is_trivially_destructible_v<Host>
+        == std::is_trivially_destructible_v<Value>
+    && libproperty::is_trivially_relocatable_v<Host>
+        == libproperty::is_trivially_relocatable_v<Value>;
+
+template <template <typename> class Host, typename... Values>
+constexpr bool mirrors_all = (mirrors<Host<Values>, Values> && ...);
+
+static_assert(mirrors_all<rw_host,
+    int,
+    double,
+    point,
+    std::array<char, 16>,
+    std::string,
+    std::unique_ptr<int>>);
+static_assert(mirrors_all<wrapper_host,
+    int,
+    double,
+    point,
+    std::array<char, 16>,
+    std::string,
+    std::unique_ptr<int>>);
+static_assert(mirrors_all<memoized_host, int, point, std::string>);
+
+static_assert(libproperty::is_trivially_relocatable_v<rw_host<point>>);
+static_assert(!libproperty::is_trivially_relocatable_v<rw_host<std::string>>);
+static_assert(std::is_trivially_copyable_v<bits_host>);
+static_assert(libproperty::is_trivially_relocatable_v<bits_host>);
+static_assert(std::is_trivially_copyable_v<facade>);
+static_assert(libproperty::is_trivially_relocatable_v<facade>);
+
+static_assert(libproperty::properties_trivially_relocatable_v<rw_host<int>>);
+static_assert(!libproperty::properties_trivially_relocatable_v<
+              wrapper_host<std::string>>);
+
+/* a host that owns memory, declared relocatable */
+class owner {
+  using pointer = std::unique_ptr<std::string>;
+
+  pointer const& get_data() const
+  {
+    return data.value;
+  }
+  pointer const& set_data(pointer x)
+  {
+    return data.value = std::move(x);
+  }
+
+public:
+  LIBPROPERTY_PROPERTY((pointer), data, get_data, set_data, owner);
+};
+
+namespace libproperty {
+template <>
+struct is_trivially_relocatable<std::unique_ptr<std::string>>
+    : std::true_type {
+};
+template <>
+struct is_trivially_relocatable<owner>
+    : std::bool_constant<properties_trivially_relocatable_v<owner>> {
+};
+} // libproperty
+
+static_assert(!std::is_trivially_copyable_v<owner>);
+static_assert(libproperty::is_trivially_relocatable_v<owner>);
+
+template <typename T, std::size_t N>
+struct buffer {
+  alignas(T) unsigned char bytes[N * sizeof(T)];
+
+  T* data()
+  {
+    return reinterpret_cast<T*>(bytes);
+  }
+};
+
+int main()
+{
+  {
+    // memmove'd hosts still find themselves through their properties
+    buffer<rw_host<int>, 4> from, to;
+    for (int i = 0; i < 4; ++i) {
+      auto* h = ::new (from.data() + i) rw_host<int>{};
+      h->value = i * 10;
+    }
+    auto* end = libproperty::relocate_n(from.data(), 4, to.data());
+    auto* hosts = std::launder(to.data());
+    assert(end == hosts + 4);
+    for (int i = 0; i < 4; ++i) {
+      assert(hosts[i].value == i * 10);
+      hosts[i].value = i;
+      assert(hosts[i].value == i);
+    }
+  }
+  {
+    // overlapping, as when erasing from the front of a vector
+    buffer<wrapper_host<int>, 3> b;
+    for (int i = 0; i < 3; ++i) {
+      auto* h = ::new (b.data() + i) wrapper_host<int>{};
+      h->value = i;
+    }
+    libproperty::relocate_n(b.data() + 1, 2, b.data());
+    auto* hosts = std::launder(b.data());
+    assert(hosts[0].value == 1);
+    assert(hosts[1].value == 2);
+  }
+  {
+    // declared relocatable: no moves, the pointer just changes address
+    buffer<owner, 1> from, to;
+    auto* o = ::new (from.data()) owner{};
+    using pointer = std::unique_ptr<std::string>;
+    o->data = std::make_unique<std::string>("seven");
+    auto const* p = static_cast<pointer const&>(o->data).get();
+    auto* moved = libproperty::relocate_at(o, to.data());
+    auto const& data = static_cast<pointer const&>(moved->data);
+    assert(data.get() == p && *data == "seven");
+    moved->~owner();
+  }
+  {
+    // not relocatable: moved and destroyed one by one
+    buffer<rw_host<std::string>, 2> from, to;
+    for (int i = 0; i < 2; ++i) {
+      auto* h = ::new (from.data() + i) rw_host<std::string>{};
+      h->value = std::string(40, char('a' + i));
+    }
+    libproperty::relocate_n(from.data(), 2, to.data());
+    for (int i = 0; i < 2; ++i) {
+      auto& h = to.data()[i];
+      std::string const s = h.value;
+      assert(s == std::string(40, char('a' + i)));
+      h.~rw_host();
+    }
+  }
+}
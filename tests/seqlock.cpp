@@ -0,0 +1,84 @@
+#include "libproperty/seqlock.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <thread>
+#include <vector>
+
+struct bbox {
+  long x0, y0, x1, y1;
+
+  bool consistent() const
+  {
+    return x0 == y0 && y0 == x1 && x1 == y1;
+  }
+};
+
+class view {
+public:
+  LIBPROPERTY_SEQLOCK((bbox), box, view);
+};
+static_assert(sizeof(view) == sizeof(libproperty::seqlock<bbox>),
+    "A seqlock property is supposed to be exactly its seqlock!");
+
+int main()
+{
+  {
+    view v;
+    bbox b = v.box;
+    assert(b.consistent() && b.x0 == 0);
+    v.box = bbox{ 1, 1, 1, 1 };
+    b = v.box;
+    assert(b.consistent() && b.x0 == 1);
+    assert(v.box.modify([](bbox& b) { return b.x0 = b.y0 = b.x1 = b.y1 = 2; })
+        == 2);
+    b = v.box;
+    assert(b.consistent() && b.x0 == 2);
+  }
+  {
+    // readers never see a half-written box
+    view v;
+    std::atomic<bool> done{ false };
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 3; ++i) {
+      readers.emplace_back([&] {
+        long last = 0;
+        while (!done.load(std::memory_order_relaxed)) {
+          bbox const b = v.box;
+          assert(b.consistent());
+          assert(b.x0 >= last);
+          last = b.x0;
+        }
+      });
+    }
+    for (long i = 1; i <= 100000; ++i) {
+      v.box = bbox{ i, i, i, i };
+    }
+    done = true;
+    for (auto& r : readers) {
+      r.join();
+    }
+  }
+  {
+    // writers serialize, so read-modify-writes do not lose updates
+    view v;
+    std::vector<std::thread> writers;
+    for (int i = 0; i < 4; ++i) {
+      writers.emplace_back([&v] {
+        for (int j = 0; j < 10000; ++j) {
+          v.box.modify([](bbox& b) {
+            ++b.x0;
+            ++b.y0;
+            ++b.x1;
+            ++b.y1;
+          });
+        }
+      });
+    }
+    for (auto& w : writers) {
+      w.join();
+    }
+    bbox const b = v.box;
+    assert(b.consistent() && b.x0 == 4 * 10000);
+  }
+}
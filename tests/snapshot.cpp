@@ -0,0 +1,249 @@
+#include "libproperty/property.hpp"
+#include "libproperty/snapshot.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <list>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/* trivially copyable: stored and used in place */
+class tick {
+  using self = tick;
+
+  long const& get_time() const
+  {
+    return time.value;
+  }
+  long const& set_time(long x)
+  {
+    return time.value = x;
+  }
+  double const& get_price() const
+  {
+    return price.value;
+  }
+  double const& set_price(double x)
+  {
+    return price.value = x;
+  }
+
+public:
+  LIBPROPERTY_PROPERTY((long), time, get_time, set_time, self);
+  LIBPROPERTY_PROPERTY((double), price, get_price, set_price, self);
+};
+static_assert(std::is_trivially_copyable_v<tick>);
+
+/* a string goes through its accessors */
+class trader {
+  using self = trader;
+
+  int const& get_id() const
+  {
+    return id.value;
+  }
+  int const& set_id(int x)
+  {
+    return id.value = x;
+  }
+  std::string const& get_name() const
+  {
+    return name.value;
+  }
+  std::string const& set_name(std::string x)
+  {
+    ++renames;
+    return name.value = std::move(x);
+  }
+  std::size_t compute_length() const
+  {
+    return name.value.size();
+  }
+
+public:
+  int renames = 0;
+
+  LIBPROPERTY_PROPERTY((int), id, get_id, set_id, self);
+  LIBPROPERTY_PROPERTY((std::string), name, get_name, set_name, self);
+  LIBPROPERTY_MEMOIZED((std::size_t), length, compute_length, self);
+  LIBPROPERTY_INVALIDATES(name, self, &self::length);
+};
+
+/* same size as tick, different schema */
+class other_tick {
+  using self = other_tick;
+
+  long const& get_when() const
+  {
+    return when.value;
+  }
+  long const& set_when(long x)
+  {
+    return when.value = x;
+  }
+  double const& get_price() const
+  {
+    return price.value;
+  }
+  double const& set_price(double x)
+  {
+    return price.value = x;
+  }
+
+public:
+  LIBPROPERTY_PROPERTY((long), when, get_when, set_when, self);
+  LIBPROPERTY_PROPERTY((double), price, get_price, set_price, self);
+};
+
+/* same names and sizes as tick, but the time is a double */
+class float_tick {
+  using self = float_tick;
+
+  double const& get_time() const
+  {
+    return time.value;
+  }
+  double const& set_time(double x)
+  {
+    return time.value = x;
+  }
+  double const& get_price() const
+  {
+    return price.value;
+  }
+  double const& set_price(double x)
+  {
+    return price.value = x;
+  }
+
+public:
+  LIBPROPERTY_PROPERTY((double), time, get_time, set_time, self);
+  LIBPROPERTY_PROPERTY((double), price, get_price, set_price, self);
+};
+static_assert(sizeof(float_tick) == sizeof(tick));
+static_assert(libproperty::snapshot_type_id<long>::value
+    != libproperty::snapshot_type_id<unsigned long>::value);
+
+/* only containers that keep their elements in one array are stored as bytes */
+static_assert(libproperty::meta::is_detected_v<
+    libproperty::impl::contiguous_data_t, std::vector<int>>);
+static_assert(libproperty::meta::is_detected_v<
+    libproperty::impl::contiguous_data_t, std::string>);
+static_assert(!libproperty::meta::is_detected_v<
+    libproperty::impl::contiguous_data_t, std::deque<int>>);
+static_assert(!libproperty::meta::is_detected_v<
+    libproperty::impl::contiguous_data_t, std::list<int>>);
+
+int main()
+{
+  {
+    std::vector<tick> ticks(100);
+    for (int i = 0; i < 100; ++i) {
+      ticks[i].time = long(i);
+      ticks[i].price = i * 0.5;
+    }
+    auto const bytes = libproperty::make_snapshot(ticks.data(), ticks.size());
+
+    // std::vector's buffer is suitably aligned: map the hosts in place
+    libproperty::snapshot_view<tick> const view(bytes.data(), bytes.size());
+    assert(view.size() == 100);
+    tick const* mapped = view.data();
+    assert(mapped[42].price == 21.0);
+    assert(reinterpret_cast<char const*>(mapped) > bytes.data());
+
+    std::vector<tick> restored(view.size());
+    view.restore(restored.data());
+    assert(restored[99].time == 99);
+
+    // a different host is refused
+    bool refused = false;
+    try {
+      libproperty::snapshot_view<other_tick> wrong(bytes.data(), bytes.size());
+    } catch (libproperty::snapshot_error const&) {
+      refused = true;
+    }
+    assert(refused);
+
+    // and one whose properties have the same names and sizes but other types
+    refused = false;
+    try {
+      libproperty::snapshot_view<float_tick> wrong(bytes.data(), bytes.size());
+    } catch (libproperty::snapshot_error const&) {
+      refused = true;
+    }
+    assert(refused);
+
+    // so is a count whose size in bytes wraps around
+    auto forged = bytes;
+    std::uint64_t const count
+        = (std::uint64_t{ 1 } << 63) / sizeof(tick) * 2 + 1;
+    std::memcpy(forged.data() + offsetof(libproperty::impl::snapshot_header,
+                                    count),
+        &count, sizeof(count));
+    refused = false;
+    try {
+      libproperty::snapshot_view<tick> forged_view(
+          forged.data(), forged.size());
+    } catch (libproperty::snapshot_error const&) {
+      refused = true;
+    }
+    assert(refused);
+  }
+  {
+    std::vector<trader> traders(3);
+    traders[0].id = 1;
+    traders[0].name = std::string{ "alice" };
+    traders[2].id = 3;
+    traders[2].name = std::string{ "carol" };
+    std::size_t const length = traders[0].length;
+    assert(length == 5);
+
+    std::ostringstream out;
+    libproperty::write_snapshot(out, traders.data(), traders.size());
+    std::string const bytes = out.str();
+
+    libproperty::snapshot_view<trader> const view(bytes.data(), bytes.size());
+    std::vector<trader> restored(view.size());
+    view.restore(restored.data());
+    int const id = restored[2].id;
+    std::string const& name = restored[2].name;
+    assert(id == 3 && name == "carol");
+    // renames is not a property, so it is not in the snapshot: it only
+    // counts the setter calls of the restore
+    assert(restored[2].renames == 1);
+    std::size_t const restored_length = restored[0].length;
+    assert(restored_length == 5);
+
+    // truncated snapshots are refused
+    libproperty::snapshot_view<trader> const cut(
+        bytes.data(), bytes.size() - 2);
+    bool refused = false;
+    try {
+      cut.restore(restored.data());
+    } catch (libproperty::snapshot_error const&) {
+      refused = true;
+    }
+    assert(refused);
+
+    // and so is a string longer than the snapshot, before it is allocated
+    std::string forged = bytes;
+    libproperty::impl::snapshot_header header;
+    std::memcpy(&header, forged.data(), sizeof(header));
+    std::uint64_t const huge = std::uint64_t{ 1 } << 62;
+    std::memcpy(forged.data() + header.data_offset + sizeof(int), &huge,
+        sizeof(huge));
+    libproperty::snapshot_view<trader> const long_name(
+        forged.data(), forged.size());
+    refused = false;
+    try {
+      long_name.restore(restored.data());
+    } catch (libproperty::snapshot_error const&) {
+      refused = true;
+    }
+    assert(refused);
+  }
+}
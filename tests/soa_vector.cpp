@@ -0,0 +1,193 @@
+#include "libproperty/property.hpp"
+#include "libproperty/soa_vector.hpp"
+
+#include <cassert>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+struct vec3 {
+  float x, y, z;
+};
+
+class particle {
+  using self = particle;
+
+  vec3 const& get_position() const
+  {
+    return position.value;
+  }
+  vec3 const& set_position(vec3 const& p)
+  {
+    ++moves;
+    return position.value = p;
+  }
+  float const& get_mass() const
+  {
+    return mass.value;
+  }
+  float const& set_mass(float m)
+  {
+    // masses are never negative
+    return mass.value = m < 0 ? 0 : m;
+  }
+
+  bool const& get_active() const
+  {
+    return active.value;
+  }
+  bool const& set_active(bool a)
+  {
+    return active.value = a;
+  }
+
+  struct plain {
+    std::string value;
+
+    std::string const& get(particle const&) const
+    {
+      return value;
+    }
+    void set(particle&, std::string x)
+    {
+      value = std::move(x);
+    }
+  };
+
+public:
+  LIBPROPERTY_PROPERTY((vec3), position, get_position, set_position, self);
+  LIBPROPERTY_PROPERTY((float), mass, get_mass, set_mass, self);
+  LIBPROPERTY_WRAP((plain), name, self);
+  LIBPROPERTY_PROPERTY((bool), active, get_active, set_active, self);
+
+  static int moves;
+};
+int particle::moves = 0;
+
+static_assert(libproperty::soa_vector<particle>::columns == 4);
+
+/* a setter that consults another property; see below */
+class gate {
+  using self = gate;
+
+  bool const& get_open() const
+  {
+    return open.value;
+  }
+  bool const& set_open(bool x)
+  {
+    return open.value = x;
+  }
+  int const& get_level() const
+  {
+    return level.value;
+  }
+  int const& set_level(int x)
+  {
+    if (open.value) {
+      level.value = x;
+    }
+    return level.value;
+  }
+
+public:
+  LIBPROPERTY_PROPERTY((bool), open, get_open, set_open, self);
+  LIBPROPERTY_PROPERTY((int), level, get_level, set_level, self);
+};
+
+int main()
+{
+  libproperty::soa_vector<particle> particles;
+  particles.reserve(4);
+  for (int i = 0; i < 4; ++i) {
+    particles.emplace_back();
+    particles[i][&particle::position] = vec3{ float(i), 0, 0 };
+    particles[i][&particle::mass] = float(i + 1);
+    particles[i][&particle::name] = std::string(std::size_t(i + 1), 'p');
+  }
+  assert(particles.size() == 4);
+  assert(particle::moves == 4);
+
+  // reads and writes go through the accessors
+  particles[2][&particle::mass] = -5.f;
+  float const m = particles[2][&particle::mass];
+  assert(m == 0.f);
+  vec3 const p = particles[3][&particle::position];
+  assert(p.x == 3.f);
+  std::string const n = particles[1][&particle::name];
+  assert(n == "pp");
+  assert(particles[1][&particle::name].get() == "pp");
+
+  // one property at a time: the rest of the element stays in its columns
+  particles[1][&particle::mass].modify([](float& x) { x *= 2; });
+  assert(particles.column(&particle::mass)[1] == 4.f);
+  assert(particles.column(&particle::name)[1].value == "pp");
+  auto const moved = particle::moves;
+  particles[1][&particle::name] = std::string{ "second" };
+  assert(particle::moves == moved);
+  assert(particles.column(&particle::position)[1].x == 1.f);
+
+  // columns are contiguous
+  float total = 0;
+  for (float const& mass : particles.column(&particle::mass)) {
+    total += mass;
+  }
+  assert(total == 1.f + 4.f + 0.f + 4.f);
+  auto const positions = particles.column(&particle::position);
+  assert(positions.size() == 4);
+  assert(&positions[1] == &positions[0] + 1);
+  assert(positions[1].x == 1.f);
+
+  // bools are kept a byte each, not packed into a std::vector<bool>
+  particles[2][&particle::active] = true;
+  bool const active = particles[2][&particle::active];
+  assert(active && !particles[1][&particle::active].get());
+  auto const flags = particles.column(&particle::active);
+  static_assert(std::is_same_v<decltype(flags.data()), unsigned char*>);
+  assert(flags[2] == 1 && flags[1] == 0);
+  particles[2][&particle::active].modify([](bool& a) { a = !a; });
+  assert(flags[2] == 0);
+
+  // elements and references are handles, and write through at once
+  auto e = particles[0];
+  e[&particle::mass] = 7.f;
+  assert(particles.column(&particle::mass)[0] == 7.f);
+  auto const r = particles[0][&particle::name];
+  r = std::string{ "first" };
+  assert(particles.column(&particle::name)[0].value == "first");
+  particles[3][&particle::mass] = particles[0][&particle::mass];
+  assert(particles.column(&particle::mass)[3] == 7.f);
+
+  // const vectors only read
+  auto const& view = particles;
+  float const first = view[0][&particle::mass];
+  assert(first == 7.f);
+  static_assert(!std::is_assignable_v<
+      libproperty::soa_vector<particle>::const_reference<decltype(
+          particle::mass)>,
+      float>);
+
+  {
+    // accessors run on a default-constructed scratch host that holds only the
+    // property accessed: set_level sees `open` as false, whatever the column
+    // holds, and drops the write
+    libproperty::soa_vector<gate> gates;
+    gate g;
+    g.open = true;
+    g.level = 1;
+    gates.push_back(g);
+    assert(gates[0][&gate::open].get());
+    gates[0][&gate::level] = 2;
+    assert(gates[0][&gate::level].get() == 1);
+  }
+
+  particle q;
+  q.mass = 9.f;
+  particles.push_back(q);
+  assert(particles.size() == 5);
+  float const last = particles[4][&particle::mass];
+  assert(last == 9.f);
+  particles.pop_back();
+  particles.clear();
+  assert(particles.empty());
+}
@@ -0,0 +1,64 @@
+#include "libproperty/striped.hpp"
+
+#include <cassert>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct account {
+  LIBPROPERTY_STRIPED((long), balance, account);
+  LIBPROPERTY_STRIPED((std::string), owner, account);
+};
+static_assert(sizeof(account) == sizeof(long) + sizeof(std::string),
+    "A striped property is supposed to be exactly its value!");
+
+/* a spinlock table of its own */
+struct counter {
+  LIBPROPERTY_WRAP(
+      (libproperty::striped<int, libproperty::spinlock, 16>), count, counter);
+};
+
+int main()
+{
+  {
+    account a;
+    a.balance = 10l;
+    a.owner = std::string{ "alice" };
+    a.balance += 5;
+    assert(a.balance == 15);
+    assert(a.balance++ == 15);
+    std::string const owner = a.owner;
+    assert(owner == "alice");
+    assert(a.owner.modify([](std::string& s) { return s += "!"; })
+        == "alice!");
+  }
+  {
+    // many small hosts, hammered from several threads
+    std::vector<account> accounts(1000);
+    std::vector<counter> counters(1000);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < 4; ++i) {
+      workers.emplace_back([&] {
+        for (int j = 0; j < 10; ++j) {
+          for (auto& a : accounts) {
+            a.balance += 1;
+            long const seen = a.balance;
+            assert(seen > 0);
+          }
+          for (auto& c : counters) {
+            ++c.count;
+          }
+        }
+      });
+    }
+    for (auto& w : workers) {
+      w.join();
+    }
+    for (auto& a : accounts) {
+      assert(a.balance == 4 * 10);
+    }
+    for (auto& c : counters) {
+      assert(c.count == 4 * 10);
+    }
+  }
+}
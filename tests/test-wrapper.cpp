@@ -119,6 +119,21 @@ int main()
     assert(x.first == y);
     assert(x.first_read() == 2);
   }
+  {
+    // between hosts, through the policies
+    counted_pair<int, int> a;
+    counted_pair<int, int> b;
+    b.first = 7;
+    b.first = 8;
+    a.first = b.first;
+    assert(a.first == 8);
+    assert(a.first_written() == 1); // not b's 2: the policy was not copied
+    assert(b.first_read() == 1);
+
+    // the host's own copy assignment copies the storage
+    a = b;
+    assert(a.first_written() == 2);
+  }
   {
     counted_pair<A, std::string> x;
     A y{ 1 };
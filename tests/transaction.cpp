@@ -0,0 +1,301 @@
+#include "libproperty/journal.hpp"
+#include "libproperty/property.hpp"
+#include "libproperty/transaction.hpp"
+
+#include <cassert>
+#include <cstdio>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+/* every write locks, validates and notifies, unless a transaction does it */
+class order {
+  using self = order;
+
+  void written()
+  {
+    if (!libproperty::in_transaction(*this)) {
+      std::lock_guard<std::mutex> const lock{ mutex };
+      validate();
+      ++notifications;
+    }
+  }
+  void validate() const
+  {
+    ++validations;
+    if (quantity.value < 0) {
+      throw std::invalid_argument("negative quantity");
+    }
+  }
+
+  int const& get_quantity() const
+  {
+    return quantity.value;
+  }
+  void set_quantity(int x)
+  {
+    quantity.value = x;
+    written();
+  }
+  double const& get_price() const
+  {
+    return price.value;
+  }
+  void set_price(double x)
+  {
+    price.value = x;
+    written();
+  }
+
+  struct text {
+    std::string value;
+
+    std::string const& get(order const&) const
+    {
+      return value;
+    }
+    void set(order& o, std::string x)
+    {
+      value = std::move(x);
+      o.written();
+    }
+  };
+
+  template <typename F>
+  void commit(F&& body)
+  {
+    std::lock_guard<std::mutex> const lock{ mutex };
+    ++commits;
+    body();
+    validate();
+    ++notifications;
+  }
+
+public:
+  std::mutex mutex;
+  int commits = 0;
+  mutable int validations = 0;
+  int notifications = 0;
+
+  LIBPROPERTY_PROPERTY((int), quantity, get_quantity, set_quantity, self);
+  LIBPROPERTY_PROPERTY((double), price, get_price, set_price, self);
+  LIBPROPERTY_WRAP((text), note, self);
+  LIBPROPERTY_COMMIT(commit, self);
+};
+
+/* rolled back through the journaled policy, so the journal agrees */
+class ledger {
+  using self = ledger;
+
+  void validate() const
+  {
+    if (balance.value.get(*this) < 0) {
+      throw std::invalid_argument("overdrawn");
+    }
+  }
+
+  template <typename F>
+  void commit(F&& body)
+  {
+    body();
+    validate();
+  }
+
+public:
+  LIBPROPERTY_JOURNALED((long), balance, self);
+  LIBPROPERTY_COMMIT(commit, self);
+};
+
+/* no rollback: nothing is saved, and a failed hook keeps the writes */
+class tally {
+  using self = tally;
+
+  int const& get_count() const
+  {
+    return count.value;
+  }
+  int const& set_count(int x)
+  {
+    return count.value = x;
+  }
+
+  template <typename F>
+  void commit(F&& body)
+  {
+    body();
+    throw std::runtime_error("not today");
+  }
+
+public:
+  LIBPROPERTY_PROPERTY((int), count, get_count, set_count, self);
+  LIBPROPERTY_COMMIT_NO_ROLLBACK(commit, self);
+};
+
+/* a broken hook that forgets to run the body */
+class forgetful {
+  using self = forgetful;
+
+  int const& get_x() const
+  {
+    return x.value;
+  }
+  int const& set_x(int v)
+  {
+    return x.value = v;
+  }
+
+  template <typename F>
+  void commit(F&&)
+  {
+  }
+
+public:
+  LIBPROPERTY_PROPERTY((int), x, get_x, set_x, self);
+  LIBPROPERTY_COMMIT(commit, self);
+};
+
+/* no hook: a transaction just groups the writes */
+class point {
+  using self = point;
+
+  int const& get_x() const
+  {
+    return x.value;
+  }
+  int const& set_x(int v)
+  {
+    return x.value = v;
+  }
+
+public:
+  LIBPROPERTY_PROPERTY((int), x, get_x, set_x, self);
+};
+
+int main()
+{
+  {
+    order o;
+    o.quantity = 1;
+    o.price = 2.5;
+    assert(o.notifications == 2 && o.validations == 2);
+
+    libproperty::transaction(o, [](auto& tx) {
+      assert(libproperty::in_transaction(tx));
+      tx.quantity = 10;
+      tx.price = 9.5;
+      tx.note = std::string{ "rush" };
+    });
+    assert(o.commits == 1);
+    assert(o.notifications == 3 && o.validations == 3);
+    assert(o.quantity == 10 && o.price == 9.5);
+    assert(!libproperty::in_transaction(o));
+
+    // nested transactions commit once, with the outermost
+    int const total = libproperty::transaction(o, [](order& tx) {
+      tx.quantity += 1;
+      libproperty::transaction(tx, [](order& inner) { inner.price = 1.0; });
+      return tx.quantity * 2;
+    });
+    assert(total == 22);
+    assert(o.commits == 2 && o.notifications == 4);
+
+    // the hook validates once, after all the writes
+    try {
+      libproperty::transaction(o, [](order& tx) {
+        tx.quantity = -1;
+        tx.quantity = 3;
+      });
+    } catch (std::invalid_argument const&) {
+      assert(false);
+    }
+    bool threw = false;
+    try {
+      libproperty::transaction(o, [](order& tx) {
+        tx.price = 4.0;
+        tx.note = std::string{ "void" };
+        tx.quantity = -1;
+      });
+    } catch (std::invalid_argument const&) {
+      threw = true;
+    }
+    assert(threw && !libproperty::in_transaction(o));
+    // rolled back through the setters, which leave it to the transaction
+    int const notified = o.notifications;
+    assert(o.quantity == 3 && o.price == 1.0);
+    assert(static_cast<std::string const&>(o.note) == "rush");
+    assert(o.notifications == notified);
+
+    // so is a body that throws
+    threw = false;
+    try {
+      libproperty::transaction(o, [](order& tx) {
+        tx.quantity = 4;
+        throw std::runtime_error("abandoned");
+      });
+    } catch (std::runtime_error const&) {
+      threw = true;
+    }
+    assert(threw && o.quantity == 3);
+
+    // only the host in the transaction is in it
+    order other;
+    libproperty::transaction(o, [&other](order&) {
+      assert(!libproperty::in_transaction(other));
+      other.quantity = 5;
+    });
+    assert(other.notifications == 1);
+  }
+  {
+    char const* const path = "transaction-journal-test.log";
+    std::remove(path);
+    ledger l;
+    {
+      libproperty::journal log(path);
+      l.balance = 5;
+      bool threw = false;
+      try {
+        libproperty::transaction(l, [](ledger& tx) { tx.balance = -7; });
+      } catch (std::invalid_argument const&) {
+        threw = true;
+      }
+      long const live = l.balance;
+      assert(threw && live == 5);
+    }
+    ledger replayed;
+    libproperty::replay(path, [&](std::uint64_t) { return &replayed; });
+    long const recorded = replayed.balance;
+    assert(recorded == 5);
+    std::remove(path);
+  }
+  {
+    tally t;
+    bool threw = false;
+    try {
+      libproperty::transaction(t, [](tally& tx) { tx.count = 3; });
+    } catch (std::runtime_error const&) {
+      threw = true;
+    }
+    assert(threw && t.count == 3);
+  }
+  {
+    forgetful f;
+    bool threw = false;
+    try {
+      libproperty::transaction(f, [](forgetful& tx) {
+        tx.x = 1;
+        return 2;
+      });
+    } catch (std::logic_error const&) {
+      threw = true;
+    }
+    assert(threw);
+  }
+  {
+    point p;
+    auto const& x = libproperty::transaction(p, [](point& tx) -> auto& {
+      tx.x = 3;
+      return tx.x;
+    });
+    assert(x == 3);
+  }
+}